@@ -9,6 +9,7 @@
 
 #include <linux/i2c.h>
 #include <linux/init.h>
+#include <linux/jiffies.h>
 #include <linux/module.h>
 
 /**
@@ -17,6 +18,575 @@
  */
 extern struct i2c_client *i2c_client;
 
+/**
+ * @brief Messages queued by the current batch.
+ */
+static struct i2c_msg batch_msgs[SSD1306_BATCH_MAX_MSGS];
+static int batch_msg_count;
+
+/**
+ * @brief Marks the messages setting an address window (SET_PAGE_ADDRESS),
+ * from which a failed transfer is replayed.
+ */
+static bool batch_anchor[SSD1306_BATCH_MAX_MSGS];
+
+/**
+ * @brief First error of a batch committed early because it was full.
+ */
+static int batch_early_status;
+
+/**
+ * @brief Address window the queued data is written into, so that it can be
+ * set again at the start of the next batch when a batch fills up in the
+ * middle of it.
+ * @param active Set once a SET_PAGE_ADDRESS has been queued.
+ * @param first_page First page of the window.
+ * @param last_page Last page of the window, inclusive.
+ * @param first_column First column of the window.
+ * @param last_column Last column of the window, inclusive.
+ * @param written Data bytes queued into the window so far.
+ * @param row_limited Set while a resumed window only covers the rest of the
+ * current page, data must not run past it.
+ */
+typedef struct {
+  bool active;
+  uint8_t first_page;
+  uint8_t last_page;
+  uint8_t first_column;
+  uint8_t last_column;
+  size_t written;
+  bool row_limited;
+} ssd1306_batch_window_t;
+
+static ssd1306_batch_window_t batch_window;
+
+/**
+ * @brief Backing storage of the queued messages, control bytes included.
+ */
+static uint8_t batch_pool[SSD1306_BATCH_POOL_LENGTH];
+static size_t batch_pool_used;
+
+/**
+ * @brief Maximum number of bytes transferred under one adapter lock hold.
+ */
+static unsigned int bus_max_chunk = SSD1306_BUS_DEFAULT_MAX_CHUNK;
+
+/**
+ * @brief Limits of the I2C adapter, see ssd1306_apply_adapter_quirks.
+ */
+static unsigned int adapter_max_msgs = SSD1306_BATCH_MAX_MSGS;
+static unsigned int adapter_max_write_len = SSD1306_BUS_MAX_CHUNK;
+
+/**
+ * @brief Bus health statistics, updated under oled_graphics_lock.
+ */
+static ssd1306_bus_health_t bus_health;
+
+/**
+ * @brief Jiffies timestamp of the next bus probe while degraded.
+ */
+static unsigned long degraded_probe_time;
+
+/**
+ * @brief Scan directions programmed by ssd1306_controller_init.
+ */
+static bool segment_remapped;
+static bool com_remapped;
+
+/**
+ * @brief Multiplex ratio and COM pins wiring programmed by
+ * ssd1306_controller_init, 128x64 unless set otherwise.
+ */
+static uint8_t mux_ratio = 63;
+static uint8_t com_pins_config = COM_PINS_ALTERNATIVE;
+
+/**
+ * @brief Submit messages through i2c_transfer, which holds the adapter lock
+ * for the whole array.
+ * @param msgs Messages to transfer.
+ * @param num Number of messages.
+ * @return Number of messages transferred or a negative errno.
+ */
+static int ssd1306_i2c_transfer(struct i2c_msg *msgs, int num) {
+  return i2c_transfer(i2c_client->adapter, msgs, num);
+}
+
+const ssd1306_transport_t ssd1306_i2c_transport = {
+    .name = "i2c", .transfer = ssd1306_i2c_transfer};
+
+/**
+ * @brief Transport used by ssd1306_batch_commit.
+ */
+static const ssd1306_transport_t *transport = &ssd1306_i2c_transport;
+
+/**
+ * @brief Check whether messages still fit into the current batch.
+ * @param msg_count Number of messages to queue.
+ * @param length Total length of the messages, control bytes included.
+ * @return true if the batch has to be committed first.
+ */
+static bool ssd1306_batch_full(int msg_count, size_t length) {
+  return (batch_msg_count + msg_count > SSD1306_BATCH_MAX_MSGS) ||
+         (batch_pool_used + length > SSD1306_BATCH_POOL_LENGTH);
+}
+
+/**
+ * @brief Commit a full batch and continue with an empty one.
+ * @param None.
+ * @return None.
+ * @note The first error is kept for the final ssd1306_batch_commit, and the
+ * address window being written survives into the new batch.
+ */
+static void ssd1306_batch_commit_early(void) {
+  int early_status = batch_early_status;
+  int status_code;
+  ssd1306_batch_window_t window = batch_window;
+
+  status_code = ssd1306_batch_commit();
+  batch_early_status = early_status ? early_status : status_code;
+  batch_window = window;
+}
+
+/**
+ * @brief Queue one message of length bytes and return its buffer.
+ * @param length Length of the message, control byte included.
+ * @return Pointer to the message buffer to be filled by the caller.
+ * @note length never exceeds SSD1306_BATCH_POOL_LENGTH, a full batch is
+ * committed first.
+ */
+static uint8_t *ssd1306_batch_reserve(size_t length) {
+  struct i2c_msg *msg;
+
+  if (ssd1306_batch_full(1, length)) {
+    ssd1306_batch_commit_early();
+  }
+
+  batch_anchor[batch_msg_count] = false;
+  msg = &batch_msgs[batch_msg_count++];
+  msg->addr = i2c_client->addr;
+  msg->flags = 0;
+  msg->len = length;
+  msg->buf = &batch_pool[batch_pool_used];
+  batch_pool_used += length;
+
+  return msg->buf;
+}
+
+/**
+ * @brief Discard any queued message and start a new batch.
+ * @param None.
+ * @return None.
+ */
+void ssd1306_batch_begin(void) {
+  batch_msg_count = 0;
+  batch_pool_used = 0;
+  batch_early_status = 0;
+  batch_window.active = false;
+}
+
+/**
+ * @brief Queue a SET_PAGE_ADDRESS / SET_COLUMN_ADDRESS pair, the page command
+ * marked as the point a failed transfer is replayed from.
+ * @param first_page First page of the window.
+ * @param last_page Last page of the window, inclusive.
+ * @param first_column First column of the window.
+ * @param last_column Last column of the window, inclusive.
+ * @return None.
+ * @note Both commands always go into the same batch.
+ */
+static void ssd1306_batch_window(uint8_t first_page, uint8_t last_page,
+                                 uint8_t first_column, uint8_t last_column) {
+  uint8_t *packet;
+
+  if (ssd1306_batch_full(2, 8)) {
+    ssd1306_batch_commit_early();
+  }
+
+  packet = ssd1306_batch_reserve(4);
+  batch_anchor[batch_msg_count - 1] = true;
+  packet[0] = CONTROL_BYTE_COMMAND_STREAM;
+  packet[1] = SET_PAGE_ADDRESS;
+  packet[2] = first_page;
+  packet[3] = last_page;
+
+  packet = ssd1306_batch_reserve(4);
+  packet[0] = CONTROL_BYTE_COMMAND_STREAM;
+  packet[1] = SET_COLUMN_ADDRESS;
+  packet[2] = first_column;
+  packet[3] = last_column;
+}
+
+/**
+ * @brief Set the address window again at the start of a new batch, where the
+ * previous batch stopped writing it.
+ * @param None.
+ * @return None.
+ * @note In the middle of a page, the window first only covers the rest of
+ * that page; ssd1306_batch_data widens it again at the end of the page.
+ */
+static void ssd1306_batch_resume_window(void) {
+  const size_t width =
+      batch_window.last_column - batch_window.first_column + 1;
+  const uint8_t page = batch_window.first_page + batch_window.written / width;
+  const uint8_t column =
+      batch_window.first_column + batch_window.written % width;
+
+  if (page > batch_window.last_page) {
+    return;
+  }
+
+  batch_window.row_limited = (column != batch_window.first_column);
+  ssd1306_batch_window(page,
+                       batch_window.row_limited ? page : batch_window.last_page,
+                       column, batch_window.last_column);
+}
+
+/**
+ * @brief Queue one command with its parameters as a single I2C message.
+ * @param command The command byte, see SSD1306 I2C command table.
+ * @param param_len Length of parameter if there is any.
+ * @param p_param Pointer to parameter to be written.
+ * @return None.
+ */
+void ssd1306_batch_command(uint8_t command, uint8_t param_len,
+                           const uint8_t *p_param) {
+  uint8_t *packet;
+
+  /* NULL pointer check. */
+  if (NULL == p_param) {
+    param_len = 0;
+  }
+
+  /* Keep track of the window, in case its data spans several batches. */
+  if ((command == SET_PAGE_ADDRESS) && (param_len == 2)) {
+    if (ssd1306_batch_full(2, 8)) {
+      ssd1306_batch_commit_early();
+    }
+    batch_window.active = true;
+    batch_window.first_page = p_param[0];
+    batch_window.last_page = p_param[1];
+    batch_window.first_column = 0;
+    batch_window.last_column = 127;
+    batch_window.written = 0;
+    batch_window.row_limited = false;
+  } else if ((command == SET_COLUMN_ADDRESS) && (param_len == 2)) {
+    batch_window.first_column = p_param[0];
+    batch_window.last_column = p_param[1];
+    batch_window.written = 0;
+  }
+
+  packet = ssd1306_batch_reserve(2 + param_len);
+  batch_anchor[batch_msg_count - 1] = (command == SET_PAGE_ADDRESS);
+  packet[0] = CONTROL_BYTE_COMMAND_STREAM;
+  packet[1] = command;
+  if (param_len > 0) {
+    memcpy(&packet[2], p_param, param_len);
+  }
+}
+
+/**
+ * @brief Queue a run of display data bytes, split into messages that each fit
+ * into one adapter lock hold.
+ * @param p_data Pointer to the data bytes to be written.
+ * @param data_len Number of data bytes to write.
+ * @return None.
+ */
+void ssd1306_batch_data(const uint8_t *p_data, size_t data_len) {
+  uint8_t *packet;
+  size_t chunk_len = 0;
+  size_t width = 0;
+
+  /* NULL pointer check. */
+  if (0 == data_len || NULL == p_data) {
+    return;
+  }
+
+  while (data_len > 0) {
+    /* One byte of each message is taken by the control byte. */
+    chunk_len = min_t(size_t, data_len, READ_ONCE(bus_max_chunk) - 1);
+
+    if (batch_window.active) {
+      width = batch_window.last_column - batch_window.first_column + 1;
+
+      /* A batch filling up mid-window continues with the window set again,
+       * so that a retry of the next batch replays to the right place. */
+      if (ssd1306_batch_full(1, 1 + chunk_len)) {
+        ssd1306_batch_commit_early();
+        ssd1306_batch_resume_window();
+      }
+      if (batch_window.row_limited) {
+        chunk_len = min_t(size_t, chunk_len,
+                          width - batch_window.written % width);
+      }
+    }
+
+    packet = ssd1306_batch_reserve(1 + chunk_len);
+    packet[0] = CONTROL_BYTE_DATA_STREAM;
+    memcpy(&packet[1], p_data, chunk_len);
+    p_data += chunk_len;
+    data_len -= chunk_len;
+
+    if (batch_window.active) {
+      batch_window.written += chunk_len;
+
+      /* The rest of the page is written, widen the window to the remaining
+       * pages again. */
+      if (batch_window.row_limited && (batch_window.written % width == 0)) {
+        batch_window.row_limited = false;
+        ssd1306_batch_resume_window();
+      }
+    }
+  }
+}
+
+/**
+ * @brief Count the messages from first on that fit into one adapter lock
+ * hold.
+ * @param first Index of the first message.
+ * @return Number of messages, at least one, at most adapter_max_msgs.
+ */
+static int ssd1306_batch_group(int first) {
+  unsigned int max_chunk = READ_ONCE(bus_max_chunk);
+  unsigned int max_msgs = READ_ONCE(adapter_max_msgs);
+  size_t hold_bytes = batch_msgs[first].len;
+  int count = 1;
+
+  while ((first + count < batch_msg_count) && (count < max_msgs) &&
+         (hold_bytes + batch_msgs[first + count].len <= max_chunk)) {
+    hold_bytes += batch_msgs[first + count].len;
+    count += 1;
+  }
+
+  return count;
+}
+
+/**
+ * @brief Find the message to replay from after a failed transfer.
+ * @param first Index of the first message of the failed transfer.
+ * @return Index of the closest preceding SET_PAGE_ADDRESS, which restores the
+ * address window the failed data was written into. first if there is none.
+ */
+static int ssd1306_batch_resync_point(int first) {
+  int index;
+
+  for (index = first; index >= 0; --index) {
+    if (batch_anchor[index]) {
+      return index;
+    }
+  }
+  return first;
+}
+
+/**
+ * @brief Book-keep the outcome of one batch and enter / leave the degraded
+ * state.
+ * @param status_code Outcome of the batch.
+ * @return None.
+ */
+static void ssd1306_update_bus_health(int status_code) {
+  if (0 == status_code) {
+    if (bus_health.degraded) {
+      pr_info("SSD1306 OLED is reachable again.\n");
+    }
+    bus_health.consecutive_failures = 0;
+    bus_health.degraded = false;
+    return;
+  }
+
+  bus_health.failed_batches += 1;
+  bus_health.consecutive_failures += 1;
+
+  if (bus_health.consecutive_failures >= SSD1306_DEGRADED_THRESHOLD) {
+    if (!bus_health.degraded) {
+      pr_err("SSD1306 OLED failed %u transfers in a row (%d), marking the "
+             "panel degraded.\n",
+             bus_health.consecutive_failures, status_code);
+    }
+    bus_health.degraded = true;
+    degraded_probe_time =
+        jiffies + msecs_to_jiffies(SSD1306_DEGRADED_PROBE_MS);
+  }
+}
+
+/**
+ * @brief Submit the queued messages through the transport.
+ * @param None.
+ * @return 0 on success, negative errno of the last failed transfer
+ * otherwise.
+ */
+int ssd1306_batch_commit(void) {
+  unsigned int backoff_us = SSD1306_RETRY_MIN_BACKOFF_US;
+  unsigned int retries = 0;
+  int first = 0;
+  int count;
+  int status_code = 0;
+
+  if (0 == batch_msg_count) {
+    status_code = batch_early_status;
+    ssd1306_batch_begin();
+    return status_code;
+  }
+
+  /* Do not spin on an unreachable panel, only probe it now and then. */
+  if (bus_health.degraded && time_before(jiffies, degraded_probe_time)) {
+    ssd1306_batch_begin();
+    return -EIO;
+  }
+
+  while (first < batch_msg_count) {
+    /* Group as many messages as fit into one adapter lock hold. */
+    count = ssd1306_batch_group(first);
+
+    status_code = transport->transfer(&batch_msgs[first], count);
+    if (status_code == count) {
+      status_code = 0;
+      first += count;
+      continue;
+    }
+
+    /* NAK, arbitration loss or a short transfer. */
+    if (status_code >= 0) {
+      status_code = -EIO;
+    }
+    bus_health.transfer_errors += 1;
+
+    if (retries == SSD1306_MAX_RETRIES) {
+      break;
+    }
+    retries += 1;
+    bus_health.retries += 1;
+
+    usleep_range(backoff_us, backoff_us * 2);
+    backoff_us = min(backoff_us * 2, SSD1306_RETRY_MAX_BACKOFF_US);
+
+    /* Part of the failed data may have landed, leaving the controller address
+     * pointer anywhere in the window. Replay from the window command. */
+    first = ssd1306_batch_resync_point(first);
+  }
+
+  if (0 == status_code) {
+    status_code = batch_early_status;
+  }
+
+  ssd1306_update_bus_health(status_code);
+  ssd1306_batch_begin();
+  return status_code;
+}
+
+/**
+ * @brief Get a snapshot of the bus health statistics.
+ * @param p_health Pointer to the struct to fill.
+ * @return None.
+ */
+void ssd1306_get_bus_health(ssd1306_bus_health_t *p_health) {
+  memcpy(p_health, &bus_health, sizeof(ssd1306_bus_health_t));
+}
+
+/**
+ * @brief Check whether the panel is considered unreachable.
+ * @param None.
+ * @return true if degraded.
+ */
+bool ssd1306_is_degraded(void) { return READ_ONCE(bus_health.degraded); }
+
+/**
+ * @brief Set the maximum number of bytes transferred under one adapter lock
+ * hold.
+ * @param max_chunk Byte count, clamped to SSD1306_BUS_MIN_CHUNK..
+ * SSD1306_BUS_MAX_CHUNK, and to the adapter max_write_len.
+ * @return None.
+ * @note No message is longer than bus_max_chunk, so it also bounds the length
+ * of every single message.
+ */
+void ssd1306_set_bus_max_chunk(unsigned int max_chunk) {
+  unsigned int max_write_len = READ_ONCE(adapter_max_write_len);
+
+  max_chunk =
+      clamp_val(max_chunk, SSD1306_BUS_MIN_CHUNK, SSD1306_BUS_MAX_CHUNK);
+  WRITE_ONCE(bus_max_chunk, min(max_chunk, max_write_len));
+}
+
+/**
+ * @brief Respect the limits of the I2C adapter: at most max_num_msgs messages
+ * per transfer (one without repeated START) and no message longer than
+ * max_write_len.
+ * @param p_quirks Quirks of the adapter, NULL if it has none.
+ * @return None.
+ * @note bus_max_chunk is clamped again, call at bind before any transfer.
+ */
+void ssd1306_apply_adapter_quirks(const struct i2c_adapter_quirks *p_quirks) {
+  unsigned int max_msgs = SSD1306_BATCH_MAX_MSGS;
+  unsigned int max_write_len = SSD1306_BUS_MAX_CHUNK;
+
+  if (p_quirks) {
+    if (p_quirks->flags & I2C_AQ_NO_REP_START) {
+      max_msgs = 1;
+    }
+    if (p_quirks->max_num_msgs) {
+      max_msgs = min_t(unsigned int, max_msgs, p_quirks->max_num_msgs);
+    }
+    /* A data message carries at least its control byte and one data byte. */
+    if (p_quirks->max_write_len) {
+      max_write_len =
+          clamp_val(p_quirks->max_write_len, 2, SSD1306_BUS_MAX_CHUNK);
+    }
+  }
+
+  WRITE_ONCE(adapter_max_msgs, max_msgs);
+  WRITE_ONCE(adapter_max_write_len, max_write_len);
+  ssd1306_set_bus_max_chunk(READ_ONCE(bus_max_chunk));
+}
+
+/**
+ * @brief Get the maximum number of bytes transferred under one adapter lock
+ * hold.
+ * @param None.
+ * @return Byte count.
+ */
+unsigned int ssd1306_get_bus_max_chunk(void) {
+  return READ_ONCE(bus_max_chunk);
+}
+
+/**
+ * @brief Replace the transport used by ssd1306_batch_commit.
+ * @param new_transport The transport, NULL restores ssd1306_i2c_transport.
+ * @return None.
+ */
+void ssd1306_set_transport(const ssd1306_transport_t *new_transport) {
+  transport = new_transport ? new_transport : &ssd1306_i2c_transport;
+}
+
+/**
+ * @brief Get the transport used by ssd1306_batch_commit.
+ * @param None.
+ * @return The transport.
+ */
+const ssd1306_transport_t *ssd1306_get_transport(void) { return transport; }
+
+/**
+ * @brief Set the scan directions programmed by ssd1306_controller_init.
+ * @param segment_remap true maps column 127 to SEG0, mirroring left to right.
+ * @param com_remap true scans COM[N-1] to COM0, mirroring top to bottom.
+ * @return None.
+ */
+void ssd1306_set_remap(bool segment_remap, bool com_remap) {
+  segment_remapped = segment_remap;
+  com_remapped = com_remap;
+}
+
+/**
+ * @brief Set the panel height programmed by ssd1306_controller_init.
+ * @param height Rows of the panel in pixels, 16 to 64.
+ * @param alternative_com_pins true for panels wired to alternating COM pins,
+ * false for sequentially wired ones.
+ * @return None.
+ */
+void ssd1306_set_geometry(uint8_t height, bool alternative_com_pins) {
+  mux_ratio = clamp_val(height, 16, 64) - 1;
+  com_pins_config =
+      alternative_com_pins ? COM_PINS_ALTERNATIVE : COM_PINS_SEQUENTIAL;
+}
+
 /**
  * @brief Write to SSD1306 register address.
  * @param control_option DATA_CONTROL indicates to transmit data,
@@ -25,68 +595,78 @@ extern struct i2c_client *i2c_client;
  * @param param_len Length of parameter if there is any.
  * @param p_param Pointer to parameter to be written.
  * @note  The I2C bus interface write-data scheme is explained in
- * section 8.1.5.1 in SSD1306 datasheet by Solomon Systech.
+ * section 8.1.5.1 in SSD1306 datasheet by Solomon Systech. The command and its
+ * parameters go out as one message.
+ * @return 0 on success, negative errno otherwise.
  */
-void ssd1306_write_address(eControl_t control_option, uint8_t address,
-                           uint8_t param_len, uint8_t *p_param) {
-  uint8_t control_byte = 0;
-  uint8_t repeat = 0;
-  /* A 2-byte tuple that consists of control and address/data bytes to abstract
-   * ssd1306 i2c communication. */
-  uint8_t packet[2];
+int ssd1306_write_address(eControl_t control_option, uint8_t address,
+                          uint8_t param_len, uint8_t *p_param) {
+  ssd1306_batch_begin();
 
   /* Differentiate COMMAND versus DATA control. */
   if (control_option == DATA_CONTROL) {
-    control_byte = SET_DISPLAY_START_LINE;
+    if (param_len > 0) {
+      ssd1306_batch_data(p_param, param_len);
+    }
   } else if (control_option == COMMAND_CONTROL) {
-    memcpy(packet, (uint8_t[]){control_byte, address}, 2);
-    i2c_master_send(i2c_client, (uint8_t[]){control_byte, address}, 2);
-  }
-
-  /* NULL pointer check. */
-  if (param_len <= 0 || NULL == p_param) {
-    goto EXIT;
+    ssd1306_batch_command(address, param_len, p_param);
   }
 
-  /* Transmit the packet. */
-  for (repeat = 0; repeat < param_len; ++repeat) {
-    memcpy(packet, (uint8_t[]){control_byte, p_param[repeat]}, 2);
-    i2c_master_send(i2c_client, packet, 2);
-  }
+  return ssd1306_batch_commit();
+}
 
-EXIT:
-  return;
+/**
+ * @brief Write a run of display data bytes to SSD1306 GDDRAM in bursts.
+ * @param p_data Pointer to the data bytes to be written.
+ * @param data_len Number of data bytes to write.
+ * @return 0 on success, negative errno otherwise.
+ */
+int ssd1306_write_data_burst(const uint8_t *p_data, size_t data_len) {
+  ssd1306_batch_begin();
+  ssd1306_batch_data(p_data, data_len);
+  return ssd1306_batch_commit();
 }
 
 /**
  * @brief Initialize SSD1306 OLED controller.
  * @param None.
- * @return None.
- * @note Using anonymous array to pass single parameters.
+ * @return 0 on success, negative errno otherwise.
+ * @note Using anonymous array to pass single parameters. The sequence is
+ * queued as one batch, so the whole init holds the bus only once.
  */
-void ssd1306_controller_init(void) {
-  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_OFF, 0, NULL);
+int ssd1306_controller_init(void) {
+  ssd1306_batch_begin();
+
+  ssd1306_batch_command(SET_DISPLAY_OFF, 0, NULL);
+
+  ssd1306_batch_command(SET_MUX_RATIO, 1, &mux_ratio);
+
+  ssd1306_batch_command(SET_DISPLAY_OFFSET, 1, (uint8_t[]){0x00});
+
+  ssd1306_batch_command(SET_DISPLAY_START_LINE, 0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_OFFSET, 1,
-                        (uint8_t[]){0x00});
+  ssd1306_batch_command(segment_remapped ? SET_SEGMENT_REMAP_REVERSED
+                                         : SET_SEGMENT_REMAP_NORMAL,
+                        0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_START_LINE, 0, NULL);
+  ssd1306_batch_command(com_remapped ? SET_COM_SCAN_REMAPPED
+                                     : SET_COM_SCAN_NORMAL,
+                        0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_CHARGE_PUMP, 0, NULL);
+  ssd1306_batch_command(SET_COM_PINS_CONFIG, 1, &com_pins_config);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_CHARGE_PUMP_ENABLE, 0, NULL);
+  ssd1306_batch_command(SET_CHARGE_PUMP, 1,
+                        (uint8_t[]){SET_CHARGE_PUMP_ENABLE});
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_MEMORY_ADDRESSING_MODE, 1,
-                        (uint8_t[]){0x00});
+  ssd1306_batch_command(SET_MEMORY_ADDRESSING_MODE, 1, (uint8_t[]){0x00});
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_CONTRAST_CONTROL, 1,
-                        (uint8_t[]){0x80});
+  ssd1306_batch_command(SET_CONTRAST_CONTROL, 1, (uint8_t[]){DEFAULT_CONTRAST});
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_ENTIRE_DISPLAY_ON, 0, NULL);
+  ssd1306_batch_command(SET_ENTIRE_DISPLAY_ON, 0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_ON, 0, NULL);
+  ssd1306_batch_command(SET_DEACTIVATE_SCROLL, 0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_DEACTIVATE_SCROLL, 0, NULL);
+  ssd1306_batch_command(SET_DISPLAY_ON, 0, NULL);
 
-  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_ON, 0, NULL);
+  return ssd1306_batch_commit();
 }
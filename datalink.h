@@ -27,21 +27,93 @@
 #define SET_CHARGE_PUMP_ENABLE 0x14
 #define SET_COLUMN_ADDRESS 0x21
 #define SET_PAGE_ADDRESS 0x22
+#define SET_SEGMENT_REMAP_NORMAL 0xA0
+#define SET_SEGMENT_REMAP_REVERSED 0xA1
+#define SET_COM_SCAN_NORMAL 0xC0
+#define SET_COM_SCAN_REMAPPED 0xC8
+#define SET_COM_PINS_CONFIG 0xDA
+
+/* SET_COM_PINS_CONFIG parameters, section 10.1.18 in SSD1306 datasheet. */
+#define COM_PINS_SEQUENTIAL 0x02
+#define COM_PINS_ALTERNATIVE 0x12
 
 #define DONT_CARE 0x00
 
+/* Contrast programmed by ssd1306_controller_init. */
+#define DEFAULT_CONTRAST 0x80
+
+/* Control bytes starting an I2C message, section 8.1.5.2 in SSD1306
+ * datasheet. With the Co bit cleared, every following byte is a command
+ * (respectively a data byte). */
+#define CONTROL_BYTE_COMMAND_STREAM 0x00
+#define CONTROL_BYTE_DATA_STREAM 0x40
+
+/* Capacity of one batch of I2C messages. A batch that fills up is committed
+ * early and continues empty. */
+#define SSD1306_BATCH_MAX_MSGS 64
+#define SSD1306_BATCH_POOL_LENGTH 2048
+
+/* Bounds of the number of bytes transferred under one adapter lock hold. */
+#define SSD1306_BUS_MIN_CHUNK 16
+#define SSD1306_BUS_DEFAULT_MAX_CHUNK 256
+#define SSD1306_BUS_MAX_CHUNK SSD1306_BATCH_POOL_LENGTH
+
+/* Bounded retry of failed transfers: the worst-case extra latency of one batch
+ * is the sum of the backoffs, 1 + 2 + 4 ms up to twice that. */
+#define SSD1306_MAX_RETRIES 3
+#define SSD1306_RETRY_MIN_BACKOFF_US 1000
+#define SSD1306_RETRY_MAX_BACKOFF_US 8000
+
+/* After this many batches failing in a row the panel is marked degraded, and
+ * the bus is only probed once per SSD1306_DEGRADED_PROBE_MS afterwards. */
+#define SSD1306_DEGRADED_THRESHOLD 5
+#define SSD1306_DEGRADED_PROBE_MS 1000
+
 /**
  * @brief Enum type for SSD1306 function to differentiate whether
  * confirguration is a command type or a data byte.
  */
 typedef enum { COMMAND_CONTROL, DATA_CONTROL } eControl_t;
 
+/**
+ * @brief Bus health statistics of the panel.
+ * @param transfer_errors Number of failed transfers, retries included.
+ * @param retries Number of transfers retried.
+ * @param failed_batches Number of batches dropped after exhausting retries.
+ * @param consecutive_failures Number of batches failed in a row.
+ * @param degraded Set while the panel is considered unreachable.
+ */
+typedef struct {
+  u32 transfer_errors;
+  u32 retries;
+  u32 failed_batches;
+  u32 consecutive_failures;
+  bool degraded;
+} ssd1306_bus_health_t;
+
+/**
+ * @brief Transport moving batches of messages to the SSD1306 controller.
+ * @param name Name of the transport, reported by benchmarks.
+ * @param transfer Submit num messages atomically with respect to other users
+ * of the bus. Returns the number of messages transferred or a negative errno.
+ */
+typedef struct {
+  const char *name;
+  int (*transfer)(struct i2c_msg *msgs, int num);
+} ssd1306_transport_t;
+
+/**
+ * @brief Default transport, submitting through i2c_transfer on the probed
+ * i2c_client.
+ */
+extern const ssd1306_transport_t ssd1306_i2c_transport;
+
 /**
  * @brief Initialize SSD1306 OLED controller.
  * @param None.
- * @return None.
+ * @return 0 on success, negative errno otherwise.
  */
-void ssd1306_controller_init(void);
+int ssd1306_controller_init(void);
 
 /**
  * @brief Write to SSD1306 register address.
@@ -50,7 +122,137 @@ void ssd1306_controller_init(void);
  * @param address The register address to write param to.
  * @param param_len Length of parameter if there is any.
  * @param p_param Pointer to parameter to be written.
+ * @return 0 on success, negative errno otherwise.
+ */
+int ssd1306_write_address(eControl_t control_option, uint8_t address,
+                          uint8_t param_len, uint8_t *param);
+
+/**
+ * @brief Write a run of display data bytes to SSD1306 GDDRAM in bursts.
+ * @param p_data Pointer to the data bytes to be written.
+ * @param data_len Number of data bytes to write.
+ * @return 0 on success, negative errno otherwise.
+ * @note The bytes are written starting at the current address window set by
+ * SET_PAGE_ADDRESS / SET_COLUMN_ADDRESS.
+ */
+int ssd1306_write_data_burst(const uint8_t *p_data, size_t data_len);
+
+/**
+ * @brief Discard any queued message and start a new batch.
+ * @param None.
+ * @return None.
+ * @note Batches are not reentrant; callers serialize through
+ * oled_graphics_lock.
+ */
+void ssd1306_batch_begin(void);
+
+/**
+ * @brief Queue one command with its parameters as a single I2C message.
+ * @param command The command byte, see SSD1306 I2C command table.
+ * @param param_len Length of parameter if there is any.
+ * @param p_param Pointer to parameter to be written.
+ * @return None.
+ */
+void ssd1306_batch_command(uint8_t command, uint8_t param_len,
+                           const uint8_t *p_param);
+
+/**
+ * @brief Queue a run of display data bytes, split into messages that each fit
+ * into one adapter lock hold.
+ * @param p_data Pointer to the data bytes to be written.
+ * @param data_len Number of data bytes to write.
+ * @return None.
+ */
+void ssd1306_batch_data(const uint8_t *p_data, size_t data_len);
+
+/**
+ * @brief Submit the queued messages through the transport.
+ * @param None.
+ * @return 0 on success, negative errno of the first failed transfer
+ * otherwise.
+ * @note Messages are grouped into i2c_transfer calls of at most the configured
+ * bus chunk bytes. Each call holds the adapter lock once, so other devices on
+ * the bus never wait longer than one chunk and never interleave within one.
+ * A failed call is retried up to SSD1306_MAX_RETRIES times with exponential
+ * backoff, replaying from the last SET_PAGE_ADDRESS so that the controller
+ * address pointer is resynchronized. A batch that fills up in the middle of
+ * an address window continues by setting the rest of the window again, so
+ * each batch carries its own resynchronization point. While the panel is degraded the batch is
+ * dropped with -EIO without touching the bus, except for one probe per
+ * SSD1306_DEGRADED_PROBE_MS.
+ */
+int ssd1306_batch_commit(void);
+
+/**
+ * @brief Get a snapshot of the bus health statistics.
+ * @param p_health Pointer to the struct to fill.
+ * @return None.
+ */
+void ssd1306_get_bus_health(ssd1306_bus_health_t *p_health);
+
+/**
+ * @brief Check whether the panel is considered unreachable.
+ * @param None.
+ * @return true if degraded.
+ */
+bool ssd1306_is_degraded(void);
+
+/**
+ * @brief Set the maximum number of bytes transferred under one adapter lock
+ * hold.
+ * @param max_chunk Byte count, clamped to SSD1306_BUS_MIN_CHUNK..
+ * SSD1306_BUS_MAX_CHUNK, and to the adapter max_write_len.
+ * @return None.
+ */
+void ssd1306_set_bus_max_chunk(unsigned int max_chunk);
+
+/**
+ * @brief Respect the limits of the I2C adapter: at most max_num_msgs messages
+ * per transfer (one without repeated START) and no message longer than
+ * max_write_len.
+ * @param p_quirks Quirks of the adapter, NULL if it has none.
+ * @return None.
+ */
+void ssd1306_apply_adapter_quirks(const struct i2c_adapter_quirks *p_quirks);
+
+/**
+ * @brief Get the maximum number of bytes transferred under one adapter lock
+ * hold.
+ * @param None.
+ * @return Byte count.
+ */
+unsigned int ssd1306_get_bus_max_chunk(void);
+
+/**
+ * @brief Replace the transport used by ssd1306_batch_commit.
+ * @param transport The transport, NULL restores ssd1306_i2c_transport.
+ * @return None.
+ */
+void ssd1306_set_transport(const ssd1306_transport_t *transport);
+
+/**
+ * @brief Get the transport used by ssd1306_batch_commit.
+ * @param None.
+ * @return The transport.
+ */
+const ssd1306_transport_t *ssd1306_get_transport(void);
+
+/**
+ * @brief Set the scan directions programmed by ssd1306_controller_init.
+ * @param segment_remap true maps column 127 to SEG0, mirroring left to right.
+ * @param com_remap true scans COM[N-1] to COM0, mirroring top to bottom.
+ * @return None.
+ * @note Takes effect at the next ssd1306_controller_init.
+ */
+void ssd1306_set_remap(bool segment_remap, bool com_remap);
+
+/**
+ * @brief Set the panel height programmed by ssd1306_controller_init.
+ * @param height Rows of the panel in pixels, 16 to 64.
+ * @param alternative_com_pins true for panels wired to alternating COM pins
+ * (128x64, 64x48), false for sequentially wired ones (128x32).
+ * @return None.
+ * @note Takes effect at the next ssd1306_controller_init.
  */
-void ssd1306_write_address(eControl_t control_option, uint8_t address,
-                           uint8_t param_len, uint8_t *param);
+void ssd1306_set_geometry(uint8_t height, bool alternative_com_pins);
 #endif /* DATALINK_H */
\ No newline at end of file
@@ -10,13 +10,26 @@
 
 #include "datalink.h"
 #include "graphics.h"
+#include "oled_console.h"
+#include "oled_frame.h"
+#include "oled_region.h"
+#include "oled_shadow_dev.h"
 #include "oled_sysfs.h"
 
 #include <linux/delay.h>
+#include <linux/freezer.h>
 #include <linux/i2c.h>
 #include <linux/kthread.h>
 #include <linux/module.h>
+#include <linux/pm.h>
+#include <linux/pm_runtime.h>
+#include <linux/property.h>
 #include <linux/sysfs.h>
+#include <linux/workqueue.h>
+
+/* Idle time after which the screen is blanked, once runtime suspend has been
+ * allowed through power/control. Tunable in power/autosuspend_delay_ms. */
+#define OLED_AUTOSUSPEND_DELAY_MS 30000
 
 /* Loadable kernel module license registration. */
 MODULE_LICENSE("GPL");
@@ -28,6 +41,13 @@ static int driver_on_probe(struct i2c_client *client,
                            const struct i2c_device_id *id);
 static int driver_on_remove(struct i2c_client *client);
 static int oled_display_text_thread(void *parameters);
+static void oled_init_work_handler(struct work_struct *work);
+static int oled_pm_suspend(struct device *dev);
+static int oled_pm_resume(struct device *dev);
+static int oled_pm_system_suspend(struct device *dev);
+static int oled_pm_system_resume(struct device *dev);
+static oled_rotation_t driver_read_rotation(struct device *dev);
+static void driver_read_geometry(struct device *dev);
 
 /**
  * @brief Identifies the device (i.e. SSD1306 OLED contoller) connected to the
@@ -40,6 +60,12 @@ struct i2c_client *i2c_client;
  */
 struct task_struct *handle_display_text_thread;
 
+/**
+ * @brief Deferred controller initialization, so that probing does not wait on
+ * the I2C transactions needed to bring the screen up.
+ */
+static DECLARE_WORK(oled_init_work, oled_init_work_handler);
+
 /**
  * @brief Link the symbol to its spawn in graphics.c
  */
@@ -72,6 +98,15 @@ static struct i2c_device_id driver_device_id[] = {{"oled_device", 0},
 
 MODULE_DEVICE_TABLE(i2c, driver_device_id);
 
+/**
+ * @brief System sleep and runtime power management callbacks. Both turn the
+ * screen off on suspend and restore the last shadow frame on resume. The frame
+ * scheduler and grayscale take a runtime PM reference around bus activity.
+ */
+static const struct dev_pm_ops driver_pm_ops = {
+    SET_SYSTEM_SLEEP_PM_OPS(oled_pm_system_suspend, oled_pm_system_resume)
+        SET_RUNTIME_PM_OPS(oled_pm_suspend, oled_pm_resume, NULL)};
+
 /* Instantiate i2c driver. */
 static struct i2c_driver i2c_driver = {
     /* Callbacks for the driver entry / exit. */
@@ -82,6 +117,9 @@ static struct i2c_driver i2c_driver = {
         {
             .name = "oled_device",
             .of_match_table = driver_id,
+            .pm = &driver_pm_ops,
+            /* Nothing on the boot path depends on the screen. */
+            .probe_type = PROBE_PREFER_ASYNCHRONOUS,
         },
 };
 
@@ -113,20 +151,99 @@ static int driver_on_probe(struct i2c_client *client,
   /* Binding instance to the probed i2c client. */
   i2c_client = client;
 
-  /* Entry to the OLED display logic. */
-  ssd1306_controller_init();
+  /* Batches are split to what the adapter can transfer at once. */
+  ssd1306_apply_adapter_quirks(client->adapter->quirks);
+
+  /* Runtime suspend blanks the screen, so only allow it on user request
+   * through /sys/devices/.../power/control. */
+  pm_runtime_set_active(&client->dev);
+  pm_runtime_forbid(&client->dev);
+  pm_runtime_set_autosuspend_delay(&client->dev, OLED_AUTOSUSPEND_DELAY_MS);
+  pm_runtime_use_autosuspend(&client->dev);
+  pm_runtime_enable(&client->dev);
+
+  /* Panel size and orientation from the device tree, programmed by the
+   * deferred init. */
+  mutex_lock(&oled_graphics_lock);
+  driver_read_geometry(&client->dev);
+  oled_set_rotation(driver_read_rotation(&client->dev));
+  mutex_unlock(&oled_graphics_lock);
 
   /* Invoke sysfs initialization from oled_sysfs.c. */
   oled_sysfs_init();
 
-  /* Create thread for oled_display_text_task function and run it. */
-  handle_display_text_thread =
-      kthread_run(oled_display_text_thread, NULL, "display_text_thread");
+  /* Create /dev/oled_console. */
+  if (oled_console_init() != 0) {
+    dev_warn(&client->dev, "Failed to register /dev/oled_console.\n");
+  }
+
+  /* Create /dev/oled_shadow. */
+  if (oled_shadow_dev_init() != 0) {
+    dev_warn(&client->dev, "Failed to register /dev/oled_shadow.\n");
+  }
+
+  /* Entry to the OLED display logic, run off the probe path. */
+  schedule_work(&oled_init_work);
 
 RETURN:
   return status_code;
 }
 
+/**
+ * @brief Read the panel size from the device properties and apply it.
+ * @param dev The device probed.
+ * @return None.
+ * @note "width" and "height" default to 128x64. Unsupported sizes fall back
+ * to 128x64 with a warning. Caller must hold oled_graphics_lock.
+ */
+static void driver_read_geometry(struct device *dev) {
+  u32 width = OLED_CANVAS_WIDTH_PIXELS;
+  u32 height = OLED_CANVAS_HEIGHT_PIXELS;
+
+  device_property_read_u32(dev, "width", &width);
+  device_property_read_u32(dev, "height", &height);
+
+  if (oled_set_geometry(width, height) != 0) {
+    dev_warn(dev, "Unsupported panel %ux%u, using 128x64.\n", width, height);
+    oled_set_geometry(OLED_CANVAS_WIDTH_PIXELS, OLED_CANVAS_HEIGHT_PIXELS);
+  }
+}
+
+/**
+ * @brief Read the panel orientation from the device properties.
+ * @param dev The device probed.
+ * @return The rotation given by "rotation" (0, 90, 180 or 270 degrees), or the
+ * flip given by "mirror-x" / "mirror-y" when unrotated.
+ */
+static oled_rotation_t driver_read_rotation(struct device *dev) {
+  u32 degrees = 0;
+
+  device_property_read_u32(dev, "rotation", &degrees);
+
+  switch (degrees) {
+  case 90:
+    return OLED_ROTATION_90;
+  case 180:
+    return OLED_ROTATION_180;
+  case 270:
+    return OLED_ROTATION_270;
+  case 0:
+    break;
+  default:
+    dev_warn(dev, "Unsupported rotation %u, using 0.\n", degrees);
+    break;
+  }
+
+  if (device_property_read_bool(dev, "mirror-x")) {
+    return OLED_MIRROR_X;
+  }
+  if (device_property_read_bool(dev, "mirror-y")) {
+    return OLED_MIRROR_Y;
+  }
+
+  return OLED_ROTATION_0;
+}
+
 /**
  * @brief Callback function pointe called on the removal of the device driver.
  *        This function implements the following prototype defined struct
@@ -136,30 +253,126 @@ RETURN:
  */
 static int driver_on_remove(struct i2c_client *client) {
   int status_code = 0;
+
+  /* The display thread is only started once initialization completes. */
+  cancel_work_sync(&oled_init_work);
+
+  /* Stop all kernel threads. */
+  if (!IS_ERR_OR_NULL(handle_display_text_thread)) {
+    status_code = kthread_stop(handle_display_text_thread);
+    handle_display_text_thread = NULL;
+  }
+
+  /* Detach sysfs first, so no store can start a mode or register the printk
+   * console again while the rest is torn down. This also stops grayscale,
+   * the dashboard or the console under display_mode_lock. */
+  oled_sysfs_remove();
+
+  /* Removes /dev/oled_console, producers never wait on the bus. */
+  oled_console_deinit();
+  oled_shadow_dev_deinit();
+
+  /* No more flushes once the producers are gone. */
+  oled_frame_deinit();
+
   /* Deinitialize oled_sysfs. */
   oled_sysfs_deinit();
   pr_info("oled_sysfs kobjects have been denintialized.\n");
 
-  /* Stop all kernel threads. */
-  status_code = kthread_stop(handle_display_text_thread);
+  pm_runtime_disable(&client->dev);
+  pm_runtime_dont_use_autosuspend(&client->dev);
 
   pr_info("oled driver kernel module has been removed.\n");
   // return status_code;
   return 0;
 }
 
+/**
+ * @brief Callback for system suspend and runtime suspend. Turns the screen
+ * off; GDDRAM content is restored from the shadow buffer on resume.
+ * @param dev Pointer to the device being suspended.
+ * @return Error status.
+ */
+static int oled_pm_suspend(struct device *dev) {
+  /* Make sure the controller has been brought up before touching it. */
+  flush_work(&oled_init_work);
+
+  mutex_lock(&oled_graphics_lock);
+  ssd1306_write_address(COMMAND_CONTROL, SET_DISPLAY_OFF, 0, NULL);
+  mutex_unlock(&oled_graphics_lock);
+
+  return 0;
+}
+
+/**
+ * @brief Callback for system resume and runtime resume. Re-initializes the
+ * controller and restores the last shadow frame in one burst instead of
+ * clearing and redrawing the screen.
+ * @param dev Pointer to the device being resumed.
+ * @return Error status.
+ * @note While grayscale owns the screen only the controller is brought up,
+ * the next subframe redraws it.
+ */
+static int oled_pm_resume(struct device *dev) {
+  int status_code = 0;
+
+  mutex_lock(&oled_graphics_lock);
+  status_code = ssd1306_controller_init();
+  if ((0 == status_code) && !oled_frame_is_held()) {
+    status_code = oled_flush_frame();
+  }
+  mutex_unlock(&oled_graphics_lock);
+
+  if (status_code != 0) {
+    /* The frame worker keeps retrying in the background. */
+    dev_warn(dev, "Restoring the OLED frame on resume failed (%d).\n",
+             status_code);
+    oled_frame_request_reinit();
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Callback for system suspend, turning the screen off unless runtime
+ * suspend already did.
+ * @param dev Pointer to the device being suspended.
+ * @return Error status.
+ */
+static int oled_pm_system_suspend(struct device *dev) {
+  if (pm_runtime_status_suspended(dev)) {
+    return 0;
+  }
+  return oled_pm_suspend(dev);
+}
+
+/**
+ * @brief Callback for system resume, leaving a runtime suspended screen off
+ * until the next flush resumes it.
+ * @param dev Pointer to the device being resumed.
+ * @return Error status.
+ */
+static int oled_pm_system_resume(struct device *dev) {
+  if (pm_runtime_status_suspended(dev)) {
+    return 0;
+  }
+  return oled_pm_resume(dev);
+}
+
 /* Helper macro for registering a modular I2C driver. */
 module_i2c_driver(i2c_driver);
 
 /**
- * @brief Thread implementing for deploying oled_graphics_params.display_text to
- * oled screen.
- * @param None.
+ * @brief Work handler bringing up the controller and the initial frame after
+ * probe, then starting oled_display_text_thread.
+ * @param work Pointer to oled_init_work.
  * @return None.
  */
-static int oled_display_text_thread(void *parameters) {
+static void oled_init_work_handler(struct work_struct *work) {
   oled_cursor_coordinate_t cursor_coordinate;
 
+  mutex_lock(&oled_graphics_lock);
+
   /* Clear the screen. */
   oled_fill_all(0x00);
 
@@ -168,20 +381,53 @@ static int oled_display_text_thread(void *parameters) {
   cursor_coordinate.position = 40;
   oled_draw_dino_map(cursor_coordinate);
 
-  while (true) {
-    /* Print the display_text in graphics structure to the oled screen. */
-    cursor_coordinate.line = 3;
-    cursor_coordinate.position = 0;
-    oled_set_cursor(cursor_coordinate);
-    oled_printf(oled_graphics_params.display_text);
+  mutex_unlock(&oled_graphics_lock);
 
-    msleep(100);
+  /* Bring the controller and the whole first frame up in one burst from the
+   * frame worker, which retries with backoff should the panel not respond. */
+  oled_frame_request_reinit();
 
-    /* When other threads calls kthread_stop on this thread. */
-    if (kthread_should_stop() == true) {
-      /* Exit this current thread.*/
-      do_exit(0);
+  /* Create thread for oled_display_text_task function and run it. */
+  handle_display_text_thread =
+      kthread_run(oled_display_text_thread, NULL, "display_text_thread");
+}
+
+/**
+ * @brief Thread implementing for deploying oled_graphics_params.display_text to
+ * oled screen.
+ * @param None.
+ * @return None.
+ */
+static int oled_display_text_thread(void *parameters) {
+  oled_cursor_coordinate_t cursor_coordinate;
+
+  /* Park the thread over system suspend so it does not race the bus. */
+  set_freezable();
+
+  /* When other threads calls kthread_stop on this thread, exit. */
+  while (!kthread_should_stop()) {
+    /* Print the display_text in graphics structure to the oled screen, unless
+     * another mode owns the canvas. */
+    mutex_lock(&oled_graphics_lock);
+    if (READ_ONCE(oled_graphics_params.display_mode) == OLED_MODE_TEXT) {
+      cursor_coordinate.line = 3;
+      cursor_coordinate.position = 0;
+      oled_set_cursor(cursor_coordinate);
+      oled_printf("%s", oled_graphics_params.display_text);
+
+      /* Regions stay on top of the text, which may wrap to any line. */
+      oled_region_redraw_overlapping(
+          0, oled_graphics_params.canvas_lines - 1, 0,
+          oled_graphics_params.canvas_columns - 1);
     }
+    mutex_unlock(&oled_graphics_lock);
+
+    /* Only changed glyphs are written, at most once per frame slot. */
+    oled_frame_request_flush();
+
+    msleep(100);
+
+    try_to_freeze();
   }
   return 0;
 }
\ No newline at end of file
@@ -8,7 +8,7 @@
 #include "graphics.h"
 #include "stdarg.h"
 
-#define FONT_CHAR_WIDTH 6
+#define FONT_CHAR_WIDTH OLED_FONT_CHAR_WIDTH
 #define ASCII_TABLE_LENGTH 128
 
 /**
@@ -176,9 +176,472 @@ const unsigned char
  * @param cursor_coordinate Keeps track of the coordinate of current cursor.
  * @param display_text Buffers/keeps track of the current text on the
  * oled_screen.
+ * @param display_mode What currently owns the oled screen.
+ * @param rotation Orientation of the canvas on the panel.
+ * @param geometry Geometry of the panel driven.
+ * @param panel_columns Width of the panel in positions (columns).
+ * @param panel_lines Height of the panel in lines (pages).
+ * @param panel_column_offset First controller column the panel is wired to.
+ * @param canvas_columns Width of the canvas in positions (columns).
+ * @param canvas_lines Height of the canvas in lines (pages).
  */
 oled_graphics_params_t oled_graphics_params = {
-    .cursor_coordinate = {.line = 0, .position = 0}, .display_text = "\0"};
+    .cursor_coordinate = {.line = 0, .position = 0},
+    .display_text = "\0",
+    .display_mode = OLED_MODE_TEXT,
+    .rotation = OLED_ROTATION_0,
+    .geometry = OLED_GEOMETRY_128X64,
+    .panel_columns = OLED_CANVAS_WIDTH_PIXELS,
+    .panel_lines = OLED_CANVAS_HEIGHT_PIXELS / BITS_PER_BYTE,
+    .panel_column_offset = 0,
+    .canvas_columns = OLED_CANVAS_WIDTH_PIXELS,
+    .canvas_lines = OLED_CANVAS_HEIGHT_PIXELS / BITS_PER_BYTE};
+
+/**
+ * @brief Shadow copy of the SSD1306 GDDRAM, laid out page-major in the same
+ * order the controller consumes it in horizontal addressing mode.
+ */
+uint8_t oled_shadow_buffer[OLED_FRAME_LENGTH];
+
+/**
+ * @brief Serializes access to the shadow buffer and the controller address
+ * window.
+ */
+DEFINE_MUTEX(oled_graphics_lock);
+
+/* Marks a line (page) with no changed columns. */
+#define OLED_DIRTY_NONE 0xFF
+
+/**
+ * @brief Struct tracking the changed spans of a page-major buffer.
+ * @param first First changed position (column) of each line (page) since the
+ * last flush. OLED_DIRTY_NONE marks a clean line.
+ * @param last Last changed position (column) of each line (page).
+ */
+typedef struct {
+  uint8_t first[OLED_CANVAS_MAX_LINES];
+  uint8_t last[OLED_CANVAS_MAX_LINES];
+} oled_dirty_spans_t;
+
+/**
+ * @brief Changed spans of the shadow buffer, in canvas coordinates.
+ */
+static oled_dirty_spans_t shadow_dirty = {
+    .first = {[0 ... OLED_CANVAS_MAX_LINES - 1] = OLED_DIRTY_NONE}};
+
+/**
+ * @brief Panel-oriented copy of the shadow buffer, only used while the canvas
+ * is rotated by 90 or 270 degrees, and its changed spans.
+ */
+static uint8_t panel_buffer[OLED_FRAME_LENGTH];
+static oled_dirty_spans_t panel_dirty = {
+    .first = {[0 ... OLED_CANVAS_MAX_LINES - 1] = OLED_DIRTY_NONE}};
+
+/* Marks a text cell where no glyph starts. */
+#define OLED_CELL_NONE 0xFF
+
+/**
+ * @brief Character grid last rendered by oled_putc: the character whose glyph
+ * starts at each position (column) of each line (page), or OLED_CELL_NONE.
+ * @note oled_putc skips re-rasterizing a glyph that is already on the canvas
+ * at the same place. A line whose pixels were changed by other drawing is
+ * flagged stale, and its grid is dropped on the next oled_putc.
+ */
+static uint8_t text_cells[OLED_CANVAS_MAX_LINES][OLED_CANVAS_WIDTH_PIXELS];
+static bool text_cells_stale[OLED_CANVAS_MAX_LINES] = {
+    [0 ... OLED_CANVAS_MAX_LINES - 1] = true};
+
+/**
+ * @brief Check whether the canvas is transposed against the panel.
+ * @param None.
+ * @return true for 90 and 270 degrees rotation.
+ */
+static inline bool oled_canvas_transposed(void) {
+  return (oled_graphics_params.rotation == OLED_ROTATION_90) ||
+         (oled_graphics_params.rotation == OLED_ROTATION_270);
+}
+
+/**
+ * @brief Extend the changed span of one line (page).
+ * @param p_dirty Spans to update.
+ * @param line The line (page) to mark.
+ * @param first_position First position (column) of the span.
+ * @param last_position Last position (column) of the span, inclusive.
+ * @return None.
+ */
+static inline void oled_dirty_extend(oled_dirty_spans_t *p_dirty, uint8_t line,
+                                     uint8_t first_position,
+                                     uint8_t last_position) {
+  if (p_dirty->first[line] == OLED_DIRTY_NONE) {
+    p_dirty->first[line] = first_position;
+    p_dirty->last[line] = last_position;
+  } else {
+    p_dirty->first[line] = min(p_dirty->first[line], first_position);
+    p_dirty->last[line] = max(p_dirty->last[line], last_position);
+  }
+}
+
+/**
+ * @brief Mark a span of columns in one line (page) of the shadow buffer as
+ * changed, so that it is written out by the next oled_flush_dirty.
+ * @param line The line (page) to mark.
+ * @param first_position First position (column) of the span.
+ * @param last_position Last position (column) of the span, inclusive.
+ * @return None.
+ */
+void oled_mark_dirty(uint8_t line, uint8_t first_position,
+                     uint8_t last_position) {
+  if (line >= oled_graphics_params.canvas_lines) {
+    return;
+  }
+
+  oled_dirty_extend(&shadow_dirty, line, first_position, last_position);
+}
+
+/**
+ * @brief Mark a range of the shadow buffer as changed after it was written
+ * directly, e.g. by /dev/oled_shadow.
+ * @param offset Offset of the range in the shadow buffer, in canvas layout.
+ * @param length Length of the range, clipped to the canvas.
+ * @return None.
+ * @note The range is split into one span per line (page) it covers.
+ */
+void oled_mark_range_dirty(size_t offset, size_t length) {
+  const size_t canvas_columns = oled_graphics_params.canvas_columns;
+  const size_t canvas_length =
+      canvas_columns * oled_graphics_params.canvas_lines;
+  size_t end, line_end;
+  uint8_t line;
+
+  if ((length == 0) || (offset >= canvas_length)) {
+    return;
+  }
+  end = min(offset + length, canvas_length);
+
+  for (; offset < end; offset = line_end) {
+    line = offset / canvas_columns;
+    line_end = min((size_t)(line + 1) * canvas_columns, end);
+    oled_dirty_extend(&shadow_dirty, line, offset % canvas_columns,
+                      (line_end - 1) % canvas_columns);
+    text_cells_stale[line] = true;
+  }
+}
+
+/**
+ * @brief Store one slice into the shadow buffer, marking it dirty only if the
+ * content actually changes.
+ * @param line The line (page) the slice is written to.
+ * @param position The position (column) the slice is written to.
+ * @param slice The byte written.
+ * @return true if the shadow buffer changed.
+ */
+static inline bool oled_shadow_update(uint8_t line, uint8_t position,
+                                      uint8_t slice) {
+  uint8_t *p_slice;
+
+  if ((line >= oled_graphics_params.canvas_lines) ||
+      (position >= oled_graphics_params.canvas_columns)) {
+    return false;
+  }
+
+  p_slice =
+      &oled_shadow_buffer[line * oled_graphics_params.canvas_columns + position];
+  if (*p_slice == slice) {
+    return false;
+  }
+
+  *p_slice = slice;
+  oled_dirty_extend(&shadow_dirty, line, position, position);
+  return true;
+}
+
+/**
+ * @brief Store one slice drawn by anything but oled_putc into the shadow
+ * buffer.
+ * @param line The line (page) the slice is written to.
+ * @param position The position (column) the slice is written to.
+ * @param slice The byte written.
+ * @return None.
+ * @note A change drops the glyphs remembered for the line, see text_cells.
+ */
+static inline void oled_shadow_store(uint8_t line, uint8_t position,
+                                     uint8_t slice) {
+  if (oled_shadow_update(line, position, slice)) {
+    text_cells_stale[line] = true;
+  }
+}
+
+/**
+ * @brief Transpose an 8x8 block of pixels, i.e. dst[k] bit b = src[b] bit k.
+ * @param p_src Eight source slices.
+ * @param src_stride Distance between two source slices.
+ * @param p_dst Eight destination slices, consecutive.
+ * @return None.
+ * @note Three delta swaps on a 64-bit word (Hacker's Delight, section 7-3)
+ * instead of 64 single bit moves.
+ */
+static inline void oled_transpose_block(const uint8_t *p_src,
+                                        size_t src_stride, uint8_t *p_dst) {
+  u64 block = 0;
+  u64 swap;
+  int slice;
+
+  for (slice = 0; slice < BITS_PER_BYTE; ++slice) {
+    block |= (u64)p_src[slice * src_stride] << (slice * BITS_PER_BYTE);
+  }
+
+  swap = (block ^ (block >> 7)) & 0x00AA00AA00AA00AAULL;
+  block ^= swap ^ (swap << 7);
+  swap = (block ^ (block >> 14)) & 0x0000CCCC0000CCCCULL;
+  block ^= swap ^ (swap << 14);
+  swap = (block ^ (block >> 28)) & 0x00000000F0F0F0F0ULL;
+  block ^= swap ^ (swap << 28);
+
+  for (slice = 0; slice < BITS_PER_BYTE; ++slice) {
+    p_dst[slice] = block >> (slice * BITS_PER_BYTE);
+  }
+}
+
+/**
+ * @brief Transpose the changed blocks of the portrait shadow buffer into the
+ * panel buffer, moving the changed spans along.
+ * @param panel_columns Width of the panel in positions (columns).
+ * @param panel_lines Height of the panel in lines (pages).
+ * @return None.
+ * @note Canvas block (line Q, positions 8P..8P+7) becomes panel block (page P,
+ * columns 8Q..8Q+7). The remaining flip of a 90 / 270 degrees rotation is
+ * done by the controller's segment remap / COM scan direction. Always inlined
+ * with a constant geometry, see oled_flush_dirty.
+ */
+static __always_inline void oled_transpose_dirty(const uint8_t panel_columns,
+                                                 const uint8_t panel_lines) {
+  const uint8_t canvas_columns = panel_lines * BITS_PER_BYTE;
+  uint8_t line, block, first_block, last_block;
+
+  for (line = 0; line < panel_columns / BITS_PER_BYTE; ++line) {
+    if (shadow_dirty.first[line] == OLED_DIRTY_NONE) {
+      continue;
+    }
+
+    first_block = shadow_dirty.first[line] / BITS_PER_BYTE;
+    last_block = shadow_dirty.last[line] / BITS_PER_BYTE;
+
+    for (block = first_block; block <= last_block; ++block) {
+      oled_transpose_block(
+          &oled_shadow_buffer[line * canvas_columns + block * BITS_PER_BYTE],
+          1,
+          &panel_buffer[block * panel_columns + line * BITS_PER_BYTE]);
+      oled_dirty_extend(&panel_dirty, block, line * BITS_PER_BYTE,
+                        line * BITS_PER_BYTE + BITS_PER_BYTE - 1);
+    }
+
+    shadow_dirty.first[line] = OLED_DIRTY_NONE;
+  }
+}
+
+/**
+ * @brief Transpose a whole portrait frame into panel orientation.
+ * @param p_src Frame laid out as panel height positions by panel width / 8
+ * lines.
+ * @param p_dst Frame in panel orientation.
+ * @return None.
+ */
+void oled_transpose_frame(const uint8_t *p_src, uint8_t *p_dst) {
+  const uint8_t panel_columns = oled_graphics_params.panel_columns;
+  const uint8_t panel_lines = oled_graphics_params.panel_lines;
+  uint8_t line, block;
+
+  for (line = 0; line < panel_columns / BITS_PER_BYTE; ++line) {
+    for (block = 0; block < panel_lines; ++block) {
+      oled_transpose_block(
+          &p_src[line * panel_lines * BITS_PER_BYTE + block * BITS_PER_BYTE],
+          1, &p_dst[block * panel_columns + line * BITS_PER_BYTE]);
+    }
+  }
+}
+
+/**
+ * @brief Queue setting the controller address window that the following data
+ * bytes are written to.
+ * @param first_line First line (page) of the window.
+ * @param last_line Last line (page) of the window, inclusive.
+ * @param first_position First position (column) of the window.
+ * @param last_position Last position (column) of the window, inclusive.
+ * @return None.
+ * @note Positions are panel positions, the controller columns are offset by
+ * the columns the panel is not wired to.
+ */
+static void oled_set_window(uint8_t first_line, uint8_t last_line,
+                            uint8_t first_position, uint8_t last_position) {
+  const uint8_t column_offset = oled_graphics_params.panel_column_offset;
+
+  ssd1306_batch_command(SET_PAGE_ADDRESS, 2,
+                        (uint8_t[]){first_line, last_line});
+  ssd1306_batch_command(
+      SET_COLUMN_ADDRESS, 2,
+      (uint8_t[]){first_position + column_offset,
+                  last_position + column_offset});
+}
+
+/**
+ * @brief Write the changed spans of a buffer in panel orientation.
+ * @param p_buffer Buffer in panel orientation.
+ * @param p_dirty Changed spans of the buffer, cleared once written.
+ * @param panel_columns Width of the panel in positions (columns).
+ * @param panel_lines Height of the panel in lines (pages).
+ * @return 1 if anything was written, 0 if the screen was up to date, negative
+ * errno if the transfer failed. Failed spans stay dirty.
+ * @note Consecutive lines with the same changed span share one address window,
+ * since the controller wraps to the next page at the end of the window. All
+ * windows go out as one batch of I2C messages. Always inlined with a constant
+ * geometry, so that the loops run to constant bounds.
+ */
+static __always_inline int oled_flush_spans(const uint8_t *p_buffer,
+                                            oled_dirty_spans_t *p_dirty,
+                                            const uint8_t panel_columns,
+                                            const uint8_t panel_lines) {
+  oled_dirty_spans_t flushed;
+  uint8_t line = 0;
+  uint8_t last_line = 0;
+  uint8_t first_position, last_position;
+  size_t span_length;
+  bool any_flushed = false;
+  int status_code;
+
+  /* Keep the spans, to mark them again should the transfer fail. */
+  memcpy(&flushed, p_dirty, sizeof(oled_dirty_spans_t));
+
+  ssd1306_batch_begin();
+
+  while (line < panel_lines) {
+    if (p_dirty->first[line] == OLED_DIRTY_NONE) {
+      line += 1;
+      continue;
+    }
+
+    first_position = p_dirty->first[line];
+    last_position = p_dirty->last[line];
+
+    /* Extend the window over following lines with the identical span. */
+    last_line = line;
+    while ((last_line < panel_lines - 1) &&
+           (p_dirty->first[last_line + 1] == first_position) &&
+           (p_dirty->last[last_line + 1] == last_position)) {
+      last_line += 1;
+    }
+
+    oled_set_window(line, last_line, first_position, last_position);
+
+    span_length = last_position - first_position + 1;
+    if (span_length == panel_columns) {
+      /* Full width lines are contiguous in the buffer. */
+      ssd1306_batch_data(&p_buffer[line * panel_columns],
+                         (last_line - line + 1) * panel_columns);
+    }
+
+    for (; line <= last_line; ++line) {
+      if (span_length != panel_columns) {
+        ssd1306_batch_data(
+            &p_buffer[line * panel_columns + first_position],
+            span_length);
+      }
+      p_dirty->first[line] = OLED_DIRTY_NONE;
+    }
+    any_flushed = true;
+  }
+
+  if (!any_flushed) {
+    return 0;
+  }
+
+  status_code = ssd1306_batch_commit();
+  if (status_code < 0) {
+    for (line = 0; line < panel_lines; ++line) {
+      if (flushed.first[line] != OLED_DIRTY_NONE) {
+        oled_dirty_extend(p_dirty, line, flushed.first[line],
+                          flushed.last[line]);
+      }
+    }
+    return status_code;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Write only the changed spans of the shadow buffer to a panel of
+ * constant geometry.
+ * @param panel_columns Width of the panel in positions (columns).
+ * @param panel_lines Height of the panel in lines (pages).
+ * @return 1 if anything was written, 0 if the screen was up to date, negative
+ * errno if the transfer failed.
+ */
+static __always_inline int oled_flush_dirty_fixed(const uint8_t panel_columns,
+                                                  const uint8_t panel_lines) {
+  if (!oled_canvas_transposed()) {
+    return oled_flush_spans(oled_shadow_buffer, &shadow_dirty, panel_columns,
+                            panel_lines);
+  }
+
+  /* Portrait canvas: only the changed 8x8 blocks are transposed. */
+  oled_transpose_dirty(panel_columns, panel_lines);
+  return oled_flush_spans(panel_buffer, &panel_dirty, panel_columns,
+                          panel_lines);
+}
+
+/**
+ * @brief Write only the changed spans of the shadow buffer to the oled screen.
+ * @param None.
+ * @return 1 if anything was written, 0 if the screen was up to date, negative
+ * errno if the transfer failed.
+ * @note Caller must hold oled_graphics_lock. Each supported geometry gets its
+ * own copy of the flush loops, specialized to its constant size.
+ */
+int oled_flush_dirty(void) {
+  switch (oled_graphics_params.geometry) {
+  case OLED_GEOMETRY_128X32:
+    return oled_flush_dirty_fixed(128, 32 / BITS_PER_BYTE);
+  case OLED_GEOMETRY_64X48:
+    return oled_flush_dirty_fixed(64, 48 / BITS_PER_BYTE);
+  case OLED_GEOMETRY_128X64:
+  default:
+    return oled_flush_dirty_fixed(128, 64 / BITS_PER_BYTE);
+  }
+}
+
+/**
+ * @brief Check whether the shadow buffer has changes not yet on the screen.
+ * @param None.
+ * @return true if oled_flush_dirty has anything to write.
+ */
+bool oled_has_dirty(void) {
+  uint8_t line;
+
+  for (line = 0; line < OLED_CANVAS_MAX_LINES; ++line) {
+    if ((shadow_dirty.first[line] != OLED_DIRTY_NONE) ||
+        (panel_dirty.first[line] != OLED_DIRTY_NONE)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Write the whole shadow buffer to the oled screen in one burst.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_flush_frame(void) {
+  uint8_t line;
+  int status_code;
+
+  for (line = 0; line < oled_graphics_params.canvas_lines; ++line) {
+    oled_mark_dirty(line, 0, oled_graphics_params.canvas_columns - 1);
+  }
+
+  status_code = oled_flush_dirty();
+  return (status_code < 0) ? status_code : 0;
+}
 
 /**
  * @brief Fill the entire screen with byte pattern.
@@ -186,16 +649,128 @@ oled_graphics_params_t oled_graphics_params = {
  * @return None.
  */
 void oled_fill_all(uint8_t pattern) {
-  oled_cursor_coordinate_t cursor_coordinate = {.line = 0, .position = 0};
+  uint8_t line;
+
+  memset(oled_shadow_buffer, pattern, oled_frame_length());
+  for (line = 0; line < oled_graphics_params.canvas_lines; ++line) {
+    oled_mark_dirty(line, 0, oled_graphics_params.canvas_columns - 1);
+    text_cells_stale[line] = true;
+  }
+}
 
-  static const int TOTAL_PIXELS = OLED_COLUMN_LENGTH * OLED_PAGE_LENGTH;
-  uint32_t pixel = 0;
+/**
+ * @brief Derive the canvas size from the panel geometry and rotation, and
+ * clear the canvas.
+ * @param None.
+ * @return None.
+ */
+static void oled_canvas_resize(void) {
+  if (oled_canvas_transposed()) {
+    oled_graphics_params.canvas_columns =
+        oled_graphics_params.panel_lines * BITS_PER_BYTE;
+    oled_graphics_params.canvas_lines =
+        oled_graphics_params.panel_columns / BITS_PER_BYTE;
+  } else {
+    oled_graphics_params.canvas_columns = oled_graphics_params.panel_columns;
+    oled_graphics_params.canvas_lines = oled_graphics_params.panel_lines;
+  }
 
-  oled_set_cursor(cursor_coordinate);
+  /* Drop spans left over from the previous geometry. */
+  memset(panel_dirty.first, OLED_DIRTY_NONE, sizeof(panel_dirty.first));
+  memset(shadow_dirty.first, OLED_DIRTY_NONE, sizeof(shadow_dirty.first));
 
-  for (pixel = 0; pixel < TOTAL_PIXELS; ++pixel) {
-    ssd1306_write_address(DATA_CONTROL, DONT_CARE, 1, &pattern);
+  oled_graphics_params.cursor_coordinate.line = 0;
+  oled_graphics_params.cursor_coordinate.position = 0;
+  oled_fill_all(0x00);
+}
+
+/**
+ * @brief Set the orientation of the canvas on the panel.
+ * @param rotation Rotation or mirroring to apply.
+ * @return None.
+ * @note Flips are free: they are done by the controller's segment remap and
+ * COM scan direction, which ssd1306_controller_init programs. A change between
+ * landscape and portrait clears the canvas, as its geometry changes. Caller
+ * must hold oled_graphics_lock, and re-initialize the controller afterwards.
+ */
+void oled_set_rotation(oled_rotation_t rotation) {
+  bool was_transposed = oled_canvas_transposed();
+  bool segment_remap = false;
+  bool com_remap = false;
+
+  switch (rotation) {
+  case OLED_ROTATION_0:
+    break;
+  case OLED_ROTATION_90:
+  case OLED_MIRROR_X:
+    segment_remap = true;
+    break;
+  case OLED_ROTATION_180:
+    segment_remap = true;
+    com_remap = true;
+    break;
+  case OLED_ROTATION_270:
+  case OLED_MIRROR_Y:
+    com_remap = true;
+    break;
+  default:
+    return;
   }
+
+  oled_graphics_params.rotation = rotation;
+  ssd1306_set_remap(segment_remap, com_remap);
+
+  if (oled_canvas_transposed() == was_transposed) {
+    return;
+  }
+
+  oled_canvas_resize();
+}
+
+/**
+ * @brief Set the geometry of the panel driven.
+ * @param width Width of the panel in pixels.
+ * @param height Height of the panel in pixels.
+ * @return 0 on success, -EINVAL if the geometry is not supported.
+ * @note The multiplex ratio and COM pins wiring are programmed by
+ * ssd1306_controller_init. Caller must hold oled_graphics_lock.
+ */
+int oled_set_geometry(unsigned int width, unsigned int height) {
+  oled_geometry_t geometry;
+  uint8_t column_offset = 0;
+  bool alternative_com_pins = true;
+
+  if ((width == 128) && (height == 64)) {
+    geometry = OLED_GEOMETRY_128X64;
+  } else if ((width == 128) && (height == 32)) {
+    geometry = OLED_GEOMETRY_128X32;
+    alternative_com_pins = false;
+  } else if ((width == 64) && (height == 48)) {
+    /* The 64 columns sit in the middle of the 128 segment driver. */
+    geometry = OLED_GEOMETRY_64X48;
+    column_offset = 32;
+  } else {
+    return -EINVAL;
+  }
+
+  oled_graphics_params.geometry = geometry;
+  oled_graphics_params.panel_columns = width;
+  oled_graphics_params.panel_lines = height / BITS_PER_BYTE;
+  oled_graphics_params.panel_column_offset = column_offset;
+  ssd1306_set_geometry(height, alternative_com_pins);
+
+  oled_canvas_resize();
+  return 0;
+}
+
+/**
+ * @brief Get the length of one frame of the panel driven.
+ * @param None.
+ * @return Length in bytes, at most OLED_FRAME_LENGTH.
+ */
+size_t oled_frame_length(void) {
+  return (size_t)oled_graphics_params.panel_columns *
+         oled_graphics_params.panel_lines;
 }
 
 /**
@@ -203,26 +778,11 @@ void oled_fill_all(uint8_t pattern) {
  * @param cursor_coordinate The pixel coordinate to set the cursor to.
  */
 void oled_set_cursor(oled_cursor_coordinate_t cursor_coordinate) {
-  uint8_t packet[2];
   /* Move the Cursor to specified position only if it is in range */
-  if ((cursor_coordinate.line <= OLED_PAGE_MAX) &&
-      (cursor_coordinate.position < OLED_COLUMN_MAX)) {
+  if ((cursor_coordinate.line < oled_graphics_params.canvas_lines) &&
+      (cursor_coordinate.position < oled_graphics_params.canvas_columns)) {
     memcpy(&oled_graphics_params.cursor_coordinate, &cursor_coordinate,
            sizeof(oled_cursor_coordinate_t));
-
-    /* Specify page (rows) start and end address. */
-    memcpy(
-        packet,
-        (uint8_t[]){oled_graphics_params.cursor_coordinate.line, OLED_PAGE_MAX},
-        2);
-    ssd1306_write_address(COMMAND_CONTROL, SET_PAGE_ADDRESS, 2, packet);
-
-    /* Specify column start and end address. */
-    memcpy(packet,
-           (uint8_t[]){oled_graphics_params.cursor_coordinate.position,
-                       OLED_COLUMN_MAX},
-           2);
-    ssd1306_write_address(COMMAND_CONTROL, SET_COLUMN_ADDRESS, 2, packet);
   }
 }
 
@@ -236,7 +796,8 @@ void oled_set_cursor(oled_cursor_coordinate_t cursor_coordinate) {
 void oled_new_line(oled_new_line_options new_line_option) {
   /* Increment and wrap-around to avoid overrun. */
   oled_graphics_params.cursor_coordinate.line += 1;
-  oled_graphics_params.cursor_coordinate.line &= OLED_PAGE_MAX;
+  oled_graphics_params.cursor_coordinate.line %=
+      oled_graphics_params.canvas_lines;
 
   if (new_line_option == START_OF_NEW_LINE) {
     /* Set cursor to the beginning of the line, thus position 0. */
@@ -248,35 +809,204 @@ void oled_new_line(oled_new_line_options new_line_option) {
   oled_set_cursor(oled_graphics_params.cursor_coordinate);
 }
 
+/**
+ * @brief Remember the glyph just rasterized at a text cell.
+ * @param line The line (page) of the glyph.
+ * @param position The position (column) the glyph starts at.
+ * @param ascii_char The character rendered.
+ * @return None.
+ * @note Glyphs starting less than one glyph width away were partly
+ * overdrawn, so they are forgotten.
+ */
+static void oled_text_cell_store(uint8_t line, uint8_t position,
+                                 unsigned char ascii_char) {
+  const int first = max(0, position - FONT_CHAR_WIDTH + 1);
+  const int last =
+      min(OLED_CANVAS_WIDTH_PIXELS - 1, position + FONT_CHAR_WIDTH - 1);
+
+  memset(&text_cells[line][first], OLED_CELL_NONE, last - first + 1);
+  text_cells[line][position] = ascii_char;
+}
+
 /**
  * @brief Put single char to the oled screen.
  * @param ascii_char ASCII character to put.
  * @return None.
+ * @note The glyph is only rasterized if text_cells does not already hold the
+ * same character at the cursor, so reprinting a mostly unchanged string costs
+ * a comparison per unchanged character.
  */
 void oled_putc(unsigned char ascii_char) {
-  uint8_t font_char_slice;
+  uint8_t line, position;
   uint8_t slice = 0;
 
   /* Change-of-line detection. */
   if (((oled_graphics_params.cursor_coordinate.position + FONT_CHAR_WIDTH) >=
-       OLED_COLUMN_LENGTH) ||
+       oled_graphics_params.canvas_columns) ||
       (ascii_char == '\n')) {
     oled_new_line(START_OF_NEW_LINE);
   }
 
+  if (ascii_char == '\n') {
+    return;
+  }
+
+  /* The font only covers 7-bit ASCII. */
+  if (ascii_char >= ASCII_TABLE_LENGTH) {
+    ascii_char = ' ';
+  }
+
+  line = oled_graphics_params.cursor_coordinate.line;
+  position = oled_graphics_params.cursor_coordinate.position;
+
+  /* Drop the grid of a line that was drawn over since. */
+  if (text_cells_stale[line]) {
+    memset(text_cells[line], OLED_CELL_NONE, sizeof(text_cells[line]));
+    text_cells_stale[line] = false;
+  }
+
   /* Print the character from the hex font table, slice by slice. */
-  if (ascii_char != '\n') {
+  if (text_cells[line][position] != ascii_char) {
     for (slice = 0; slice < FONT_CHAR_WIDTH; slice += 1) {
-      font_char_slice = FONT_TABLE[ascii_char][slice];
-      ssd1306_write_address(DATA_CONTROL, DONT_CARE, 1, &font_char_slice);
-      oled_graphics_params.cursor_coordinate.position += 1;
+      oled_shadow_update(line, position + slice, FONT_TABLE[ascii_char][slice]);
+    }
+    oled_text_cell_store(line, position, ascii_char);
+  }
+
+  oled_graphics_params.cursor_coordinate.position += FONT_CHAR_WIDTH;
+}
+
+/**
+ * @brief Fill a rectangular window of the screen with byte pattern.
+ * @param first_line First line (page) of the window.
+ * @param last_line Last line (page) of the window, inclusive.
+ * @param first_position First position (column) of the window.
+ * @param last_position Last position (column) of the window, inclusive.
+ * @param pattern Byte pattern to fill.
+ * @return None.
+ */
+void oled_fill_window(uint8_t first_line, uint8_t last_line,
+                      uint8_t first_position, uint8_t last_position,
+                      uint8_t pattern) {
+  unsigned int line, position;
+
+  for (line = first_line; line <= last_line; ++line) {
+    for (position = first_position; position <= last_position; ++position) {
+      oled_shadow_store(line, position, pattern);
+    }
+  }
+}
+
+/**
+ * @brief Spread the bits of a nibble over a byte, each bit doubled.
+ * @param nibble Four bits of a glyph slice.
+ * @return The magnified slice, e.g. 0b0101 gives 0b00110011.
+ */
+static inline uint8_t oled_double_bits(uint8_t nibble) {
+  uint8_t doubled = 0;
+  int bit;
+
+  for (bit = 0; bit < 4; ++bit) {
+    if (nibble & (1 << bit)) {
+      doubled |= 0x3 << (bit * 2);
+    }
+  }
+  return doubled;
+}
+
+/**
+ * @brief Draw one row of text into a window, clipped to it.
+ * @param line First line (page) of the row, the row covers scale lines.
+ * @param first_position First position (column) of the window.
+ * @param last_position Last position (column) of the window, inclusive.
+ * @param p_text Text to draw, not necessarily NUL terminated.
+ * @param text_len Number of characters of p_text to draw.
+ * @param align Alignment of the text in the window.
+ * @param scale Glyph magnification, 1 to OLED_FONT_SCALE_MAX.
+ * @param invert true to draw dark text on a lit background.
+ * @return None.
+ */
+void oled_draw_text_span(uint8_t line, uint8_t first_position,
+                         uint8_t last_position, const char *p_text,
+                         size_t text_len, oled_text_align_t align,
+                         uint8_t scale, bool invert) {
+  const int glyph_width = FONT_CHAR_WIDTH * scale;
+  const int window_width = last_position - first_position + 1;
+  const int text_width = text_len * glyph_width;
+  const uint8_t background = invert ? 0xFF : 0x00;
+  unsigned char ascii_char;
+  int origin, offset, position;
+  uint8_t slice;
+
+  if ((scale < 1) || (scale > OLED_FONT_SCALE_MAX) ||
+      (line + scale > oled_graphics_params.canvas_lines)) {
+    return;
+  }
+
+  /* Position of the first text column, relative to the window. */
+  if (align == OLED_ALIGN_RIGHT) {
+    origin = window_width - text_width;
+  } else if (align == OLED_ALIGN_CENTER) {
+    origin = (window_width - text_width) / 2;
+  } else {
+    origin = 0;
+  }
+
+  for (position = 0; position < window_width; ++position) {
+    offset = position - origin;
+
+    if ((offset < 0) || (offset >= text_width)) {
+      slice = 0x00;
+    } else {
+      ascii_char = p_text[offset / glyph_width];
+      if (ascii_char >= ASCII_TABLE_LENGTH) {
+        ascii_char = ' ';
+      }
+      slice = FONT_TABLE[ascii_char][(offset % glyph_width) / scale];
+    }
+
+    if (scale == 1) {
+      oled_shadow_store(line, first_position + position, slice ^ background);
+    } else {
+      oled_shadow_store(line, first_position + position,
+                        oled_double_bits(slice & 0x0F) ^ background);
+      oled_shadow_store(line + 1, first_position + position,
+                        oled_double_bits(slice >> 4) ^ background);
+    }
+  }
+}
+
+/**
+ * @brief Draw a page-major bitmap into a window.
+ * @param line First line (page) of the window.
+ * @param position First position (column) of the window.
+ * @param lines Height of the bitmap in lines (pages).
+ * @param columns Width of the bitmap in positions (columns).
+ * @param p_bitmap lines * columns bytes, one line (page) after the other.
+ * @return None.
+ */
+void oled_draw_bitmap(uint8_t line, uint8_t position, uint8_t lines,
+                      uint8_t columns, const uint8_t *p_bitmap) {
+  unsigned int row, column, columns_drawn;
+
+  /* Clip to the canvas, before the coordinates could wrap around. */
+  lines = min_t(unsigned int, lines,
+                max(0, oled_graphics_params.canvas_lines - line));
+  columns_drawn = min_t(unsigned int, columns,
+                        max(0, oled_graphics_params.canvas_columns - position));
+
+  for (row = 0; row < lines; ++row) {
+    for (column = 0; column < columns_drawn; ++column) {
+      oled_shadow_store(line + row, position + column,
+                        p_bitmap[row * columns + column]);
     }
   }
 }
 
 /**
  * @brief printf on oled with variadic arguments to print on the oled screen.
- * @param format Format supplied including string and/or parameters.
+ * @param format Format supplied including string and/or parameters, never
+ * user supplied text.
  * @return None.
  */
 void oled_printf(const char *format, ...) {
@@ -284,12 +1014,9 @@ void oled_printf(const char *format, ...) {
   char *p_message_buffer = NULL;
   va_list args;
 
-  memset(message_buffer, '\0', DEFAULT_TEXT_LENGTH);
-
-  /* Initialize pointer */
   /* Append the variable argument lists. */
   va_start(args, format);
-  vsprintf(message_buffer, format, args);
+  vsnprintf(message_buffer, DEFAULT_TEXT_LENGTH, format, args);
   va_end(args);
 
   p_message_buffer = (char *)message_buffer;
@@ -314,7 +1041,10 @@ void oled_draw_dino_map(oled_cursor_coordinate_t cursor_coordinate) {
   for (row = 0; row < DINOSAUR_BITMAP_ROWS; row += 1) {
     for (column = 0; column < DINOSAUR_BITMAP_COLUMNS; column += 1) {
       slice = DINOSAUR_BITMAP[row][column];
-      ssd1306_write_address(DATA_CONTROL, DONT_CARE, 1, &slice);
+      oled_shadow_store(oled_graphics_params.cursor_coordinate.line,
+                        oled_graphics_params.cursor_coordinate.position +
+                            column,
+                        slice);
     }
     oled_new_line(SAME_CURSOR_POSITION);
   }
@@ -10,6 +10,10 @@
 
 #include "datalink.h"
 
+#include <linux/mutex.h>
+
+/* Largest panel supported, buffers are sized for it. The panel actually
+ * driven is set by oled_set_geometry. */
 #define OLED_CANVAS_WIDTH_PIXELS 128
 #define OLED_CANVAS_HEIGHT_PIXELS 64
 #define BITS_PER_BYTE 8
@@ -22,8 +26,18 @@
 #define OLED_PAGE_MIN 0
 #define OLED_PAGE_MAX (OLED_CANVAS_HEIGHT_PIXELS / BITS_PER_BYTE) - 1
 
+#define OLED_FRAME_LENGTH (OLED_COLUMN_LENGTH * OLED_PAGE_LENGTH)
+
+/* Lines (pages) of the canvas when rotated into portrait orientation. */
+#define OLED_CANVAS_MAX_LINES (OLED_CANVAS_WIDTH_PIXELS / BITS_PER_BYTE)
+
 #define DEFAULT_TEXT_LENGTH 256
 
+/* Width of one glyph of the built-in font, in positions (columns). */
+#define OLED_FONT_CHAR_WIDTH 6
+/* Largest glyph magnification, 2 draws 12x16 glyphs over two lines. */
+#define OLED_FONT_SCALE_MAX 2
+
 /**
  * @struct Pixel location on the screen.
  * @param line The horizontal line (page).
@@ -51,15 +65,93 @@ typedef struct {
   uint8_t position; /* Valid range 0 - 127 */
 } oled_cursor_coordinate_t;
 
+/**
+ * @brief Enum type defining what currently owns the oled screen.
+ * @param OLED_MODE_TEXT display_text is printed by oled_display_text_thread.
+ * @param OLED_MODE_GRAYSCALE The uploaded grayscale image is shown by
+ * cycling bitplanes, see oled_grayscale.c. The shadow buffer is not flushed.
+ * @param OLED_MODE_DASHBOARD The uploaded dashboard layout is shown with its
+ * fields refreshed from kernel sources, see oled_dashboard.c.
+ * @param OLED_MODE_CONSOLE The last lines written to /dev/oled_console are
+ * shown, see oled_console.c.
+ */
+typedef enum {
+  OLED_MODE_TEXT,
+  OLED_MODE_GRAYSCALE,
+  OLED_MODE_DASHBOARD,
+  OLED_MODE_CONSOLE
+} oled_display_mode_t;
+
+/**
+ * @brief Enum type defining the orientation of the canvas on the panel.
+ * @param OLED_ROTATION_0 Native landscape orientation, 128x64.
+ * @param OLED_ROTATION_90 Portrait, 64x128, rotated clockwise.
+ * @param OLED_ROTATION_180 Landscape, upside down.
+ * @param OLED_ROTATION_270 Portrait, 64x128, rotated counter-clockwise.
+ * @param OLED_MIRROR_X Landscape, mirrored left to right.
+ * @param OLED_MIRROR_Y Landscape, mirrored top to bottom.
+ */
+typedef enum {
+  OLED_ROTATION_0,
+  OLED_ROTATION_90,
+  OLED_ROTATION_180,
+  OLED_ROTATION_270,
+  OLED_MIRROR_X,
+  OLED_MIRROR_Y
+} oled_rotation_t;
+
+/**
+ * @brief Enum type defining the panel geometries supported.
+ * @param OLED_GEOMETRY_128X64 128x64 panel, alternative COM pins.
+ * @param OLED_GEOMETRY_128X32 128x32 panel, sequential COM pins.
+ * @param OLED_GEOMETRY_64X48 64x48 panel, alternative COM pins, wired to
+ * segments 32 to 95.
+ */
+typedef enum {
+  OLED_GEOMETRY_128X64,
+  OLED_GEOMETRY_128X32,
+  OLED_GEOMETRY_64X48
+} oled_geometry_t;
+
+/**
+ * @brief Enum type defining the horizontal alignment of text in a window.
+ * @param OLED_ALIGN_LEFT Text starts at the left edge, clipped on the right.
+ * @param OLED_ALIGN_CENTER Text is centered, clipped on both edges.
+ * @param OLED_ALIGN_RIGHT Text ends at the right edge, clipped on the left.
+ */
+typedef enum {
+  OLED_ALIGN_LEFT,
+  OLED_ALIGN_CENTER,
+  OLED_ALIGN_RIGHT
+} oled_text_align_t;
+
 /**
  * @brief Struct used to book-keep parameters for the oled graphics.
  * @param cursor_coordinate Keeps track of the coordinate of current cursor.
  * @param display_text Buffers/keeps track of the current text on the
  * oled_screen.
+ * @param display_mode What currently owns the oled screen.
+ * @param rotation Orientation of the canvas on the panel.
+ * @param geometry Geometry of the panel driven.
+ * @param panel_columns Width of the panel in positions (columns).
+ * @param panel_lines Height of the panel in lines (pages).
+ * @param panel_column_offset First controller column the panel is wired to.
+ * @param canvas_columns Width of the canvas in positions (columns), e.g. 128
+ * in landscape and 64 in portrait on a 128x64 panel.
+ * @param canvas_lines Height of the canvas in lines (pages), e.g. 8 in
+ * landscape and 16 in portrait on a 128x64 panel.
  */
 typedef struct {
   oled_cursor_coordinate_t cursor_coordinate;
   char display_text[DEFAULT_TEXT_LENGTH];
+  oled_display_mode_t display_mode;
+  oled_rotation_t rotation;
+  oled_geometry_t geometry;
+  uint8_t panel_columns;
+  uint8_t panel_lines;
+  uint8_t panel_column_offset;
+  uint8_t canvas_columns;
+  uint8_t canvas_lines;
 } oled_graphics_params_t;
 
 /**
@@ -71,6 +163,20 @@ typedef struct {
  */
 typedef enum { START_OF_NEW_LINE, SAME_CURSOR_POSITION } oled_new_line_options;
 
+/**
+ * @brief Shadow copy of the SSD1306 GDDRAM, laid out page-major in the same
+ * order the controller consumes it in horizontal addressing mode.
+ * @note Original symbol declared in graphics.c.
+ */
+extern uint8_t oled_shadow_buffer[OLED_FRAME_LENGTH];
+
+/**
+ * @brief Serializes access to the shadow buffer and the controller address
+ * window between the display thread, sysfs and power management callbacks.
+ * @note Original symbol declared in graphics.c.
+ */
+extern struct mutex oled_graphics_lock;
+
 /**
  * @brief Print single char to the oled screen.
  * @param ascii_char ASCII character to put.
@@ -80,10 +186,11 @@ void oled_putc(unsigned char c);
 
 /**
  * @brief printf on oled with variadic arguments to print on the oled screen.
- * @param format Format supplied including string and/or parameters.
+ * @param format Format supplied including string and/or parameters, never
+ * user supplied text.
  * @return None.
  */
-void oled_printf(const char *format, ...);
+__printf(1, 2) void oled_printf(const char *format, ...);
 
 /**
  * @brief Change to a new line on the OLED screen.
@@ -97,6 +204,8 @@ void oled_new_line(oled_new_line_options new_line_option);
 /**
  * @brief Set the cursor position, i.e. the start location to print.
  * @param cursor_coordinate The pixel coordinate to set the cursor to.
+ * @note Only the shadow buffer cursor is moved, the controller address window
+ * is set when the frame is flushed.
  */
 void oled_set_cursor(oled_cursor_coordinate_t cursor_coordinate);
 
@@ -104,9 +213,145 @@ void oled_set_cursor(oled_cursor_coordinate_t cursor_coordinate);
  * @brief Fill the entire screen with byte pattern.
  * @param pattern Byte pattern to fill.
  * @return None.
+ * @note Like all drawing functions, only the shadow buffer is changed. The
+ * screen is updated by oled_flush_dirty / oled_frame_request_flush.
  */
 void oled_fill_all(uint8_t pattern);
 
+/**
+ * @brief Mark a span of columns in one line (page) of the shadow buffer as
+ * changed, so that it is written out by the next oled_flush_dirty.
+ * @param line The line (page) to mark.
+ * @param first_position First position (column) of the span.
+ * @param last_position Last position (column) of the span, inclusive.
+ * @return None.
+ */
+void oled_mark_dirty(uint8_t line, uint8_t first_position,
+                     uint8_t last_position);
+
+/**
+ * @brief Mark a range of the shadow buffer as changed after it was written
+ * directly, e.g. by /dev/oled_shadow.
+ * @param offset Offset of the range in the shadow buffer, in canvas layout.
+ * @param length Length of the range, clipped to the canvas.
+ * @return None.
+ * @note Caller must hold oled_graphics_lock.
+ */
+void oled_mark_range_dirty(size_t offset, size_t length);
+
+/**
+ * @brief Write only the changed spans of the shadow buffer to the oled screen.
+ * @param None.
+ * @return 1 if anything was written, 0 if the screen was up to date, negative
+ * errno if the transfer failed. Failed spans stay dirty for the next flush.
+ * @note Caller must hold oled_graphics_lock.
+ */
+int oled_flush_dirty(void);
+
+/**
+ * @brief Check whether the shadow buffer has changes not yet on the screen.
+ * @param None.
+ * @return true if oled_flush_dirty has anything to write.
+ * @note Caller must hold oled_graphics_lock.
+ */
+bool oled_has_dirty(void);
+
+/**
+ * @brief Write the whole shadow buffer to the oled screen in one burst.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ * @note Used to restore the last frame after the controller has been
+ * re-initialized, e.g. on resume. Caller must hold oled_graphics_lock.
+ */
+int oled_flush_frame(void);
+
+/**
+ * @brief Fill a rectangular window of the screen with byte pattern.
+ * @param first_line First line (page) of the window.
+ * @param last_line Last line (page) of the window, inclusive.
+ * @param first_position First position (column) of the window.
+ * @param last_position Last position (column) of the window, inclusive.
+ * @param pattern Byte pattern to fill.
+ * @return None.
+ */
+void oled_fill_window(uint8_t first_line, uint8_t last_line,
+                      uint8_t first_position, uint8_t last_position,
+                      uint8_t pattern);
+
+/**
+ * @brief Draw one row of text into a window, clipped to it.
+ * @param line First line (page) of the row, the row covers scale lines.
+ * @param first_position First position (column) of the window.
+ * @param last_position Last position (column) of the window, inclusive.
+ * @param p_text Text to draw, not necessarily NUL terminated.
+ * @param text_len Number of characters of p_text to draw.
+ * @param align Alignment of the text in the window.
+ * @param scale Glyph magnification, 1 to OLED_FONT_SCALE_MAX.
+ * @param invert true to draw dark text on a lit background.
+ * @return None.
+ * @note Columns of the window not covered by text are cleared, so that the
+ * row fully replaces what was drawn before. Only bytes that change are marked
+ * dirty. Caller must hold oled_graphics_lock.
+ */
+void oled_draw_text_span(uint8_t line, uint8_t first_position,
+                         uint8_t last_position, const char *p_text,
+                         size_t text_len, oled_text_align_t align,
+                         uint8_t scale, bool invert);
+
+/**
+ * @brief Draw a page-major bitmap into a window.
+ * @param line First line (page) of the window.
+ * @param position First position (column) of the window.
+ * @param lines Height of the bitmap in lines (pages).
+ * @param columns Width of the bitmap in positions (columns).
+ * @param p_bitmap lines * columns bytes, one line (page) after the other.
+ * @return None.
+ * @note Parts outside of the canvas are clipped. Caller must hold
+ * oled_graphics_lock.
+ */
+void oled_draw_bitmap(uint8_t line, uint8_t position, uint8_t lines,
+                      uint8_t columns, const uint8_t *p_bitmap);
+
+/**
+ * @brief Set the orientation of the canvas on the panel.
+ * @param rotation Rotation or mirroring to apply.
+ * @return None.
+ * @note Flips and 180 degrees rotation are done by the controller at no cost.
+ * 90 and 270 degrees rotation turn the canvas to portrait, e.g. 64x128,
+ * which is transposed in 8x8 blocks while flushing, and clear the canvas.
+ * Caller must hold oled_graphics_lock and call oled_frame_request_reinit
+ * afterwards.
+ */
+void oled_set_rotation(oled_rotation_t rotation);
+
+/**
+ * @brief Transpose a whole portrait frame into panel orientation.
+ * @param p_src Frame laid out in portrait canvas orientation, e.g. 16 lines of
+ * 64 positions on a 128x64 panel.
+ * @param p_dst Frame in panel orientation, e.g. 8 lines of 128 positions.
+ * @return None.
+ */
+void oled_transpose_frame(const uint8_t *p_src, uint8_t *p_dst);
+
+/**
+ * @brief Set the geometry of the panel driven.
+ * @param width Width of the panel in pixels.
+ * @param height Height of the panel in pixels.
+ * @return 0 on success, -EINVAL if the geometry is not supported.
+ * @note Only the rows and columns of the panel are flushed, so smaller panels
+ * transfer smaller frames. Clears the canvas. Caller must hold
+ * oled_graphics_lock and re-initialize the controller afterwards.
+ */
+int oled_set_geometry(unsigned int width, unsigned int height);
+
+/**
+ * @brief Get the length of one frame of the panel driven.
+ * @param None.
+ * @return Length in bytes, at most OLED_FRAME_LENGTH.
+ * @note The shadow buffer holds one frame in canvas layout.
+ */
+size_t oled_frame_length(void);
+
 /**
  * @brief Draw a dinosaur on the oled screen.
  * @param cursor_coordinate Set to this coordinate as the start pixel drawing
@@ -0,0 +1,469 @@
+/**
+ * @file oled_console.c
+ * @brief Log-tail console implementation. Producers (writers of
+ * /dev/oled_console, and printk when mirrored) append lines to a ring without
+ * ever touching the I2C bus. A work item drains the ring at most once per
+ * frame slot and draws only the last lines that fit the canvas, so a burst of
+ * lines collapses into a single frame update.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_console.h"
+#include "oled_frame.h"
+#include "oled_region.h"
+
+#include <linux/console.h>
+#include <linux/fs.h>
+#include <linux/irq_work.h>
+#include <linux/miscdevice.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+#include <linux/workqueue.h>
+
+/* Bytes copied from user space at a time by oled_console_dev_write. */
+#define OLED_CONSOLE_CHUNK_LENGTH 64
+/* Attempts to read a consistent tail before retrying at the next frame. */
+#define OLED_CONSOLE_READ_TRIES 3
+
+/* Function signatures. */
+static void oled_console_irq_work_handler(struct irq_work *work);
+static void oled_console_work_handler(struct work_struct *work);
+static void oled_console_write(struct console *console, const char *p_text,
+                               unsigned int text_len);
+static ssize_t oled_console_dev_write(struct file *file,
+                                      const char __user *p_buffer,
+                                      size_t count, loff_t *p_offset);
+
+/**
+ * @brief Link the symbol to its spawn in graphics.c
+ */
+extern oled_graphics_params_t oled_graphics_params;
+
+/**
+ * @brief One line of the ring.
+ * @param sequence 2 * n + 1 while line n is being written, 2 * n + 2 once it
+ * is complete. Lets the consumer detect a slot overwritten under it.
+ * @param length Length of text.
+ * @param text The line, not NUL terminated.
+ */
+typedef struct {
+  unsigned long sequence;
+  uint8_t length;
+  char text[OLED_CONSOLE_LINE_LENGTH];
+} oled_console_slot_t;
+
+/**
+ * @brief The ring. Producers are serialized by producer_lock among
+ * themselves; the single consumer, oled_console_work_handler, takes no lock.
+ */
+static oled_console_slot_t slots[OLED_CONSOLE_SLOTS];
+
+/**
+ * @brief Number of lines published, i.e. index of the next line.
+ */
+static unsigned long console_head;
+
+/**
+ * @brief Serializes producers, never held across anything that may sleep.
+ */
+static DEFINE_SPINLOCK(producer_lock);
+
+/**
+ * @brief Value of console_head at the last drawn tail, only used by the
+ * consumer.
+ */
+static unsigned long console_drawn_head;
+
+/**
+ * @brief true while the console owns the screen.
+ */
+static bool console_active;
+
+/**
+ * @brief Wakes the consumer from any producer context, including printk.
+ */
+static struct irq_work console_irq_work;
+
+/**
+ * @brief Delayed work draining the ring at the next frame slot.
+ */
+static DECLARE_DELAYED_WORK(console_work, oled_console_work_handler);
+
+/**
+ * @brief Console registered with printk while kernel messages are mirrored.
+ */
+static struct console oled_printk_console = {
+    .name = "oled",
+    .write = oled_console_write,
+    .flags = CON_ENABLED,
+    .index = -1};
+
+/**
+ * @brief true while oled_printk_console is registered, protected by
+ * printk_console_lock.
+ */
+static bool printk_console_registered;
+static DEFINE_MUTEX(printk_console_lock);
+
+/**
+ * @brief File operations of /dev/oled_console.
+ */
+static const struct file_operations oled_console_fops = {
+    .owner = THIS_MODULE,
+    .write = oled_console_dev_write,
+    .llseek = noop_llseek};
+
+/**
+ * @brief /dev/oled_console, write-only and root only, so unprivileged users
+ * cannot inject lines looking like kernel messages.
+ */
+static struct miscdevice oled_console_device = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = "oled_console",
+    .fops = &oled_console_fops,
+    .mode = 0200};
+
+/**
+ * @brief true once oled_console_device has been registered.
+ */
+static bool oled_console_device_registered;
+
+/**
+ * @brief Append one line to the console ring.
+ * @param p_text Text of the line, without newline.
+ * @param text_len Length of p_text, truncated to OLED_CONSOLE_LINE_LENGTH.
+ * @param may_drop true to drop the line instead of spinning on a contended
+ * producer_lock, for the printk path: a CPU stopped by panic while holding it
+ * must not deadlock console_flush_on_panic.
+ * @return false if the line was dropped.
+ */
+static bool oled_console_enqueue(const char *p_text, size_t text_len,
+                                 bool may_drop) {
+  oled_console_slot_t *p_slot;
+  unsigned long flags;
+  unsigned long index;
+
+  text_len = min_t(size_t, text_len, OLED_CONSOLE_LINE_LENGTH);
+
+  if (!may_drop) {
+    spin_lock_irqsave(&producer_lock, flags);
+  } else if (!spin_trylock_irqsave(&producer_lock, flags)) {
+    return false;
+  }
+
+  index = console_head;
+  p_slot = &slots[index & (OLED_CONSOLE_SLOTS - 1)];
+
+  WRITE_ONCE(p_slot->sequence, 2 * index + 1);
+  smp_wmb();
+  memcpy(p_slot->text, p_text, text_len);
+  p_slot->length = text_len;
+  smp_wmb();
+  WRITE_ONCE(p_slot->sequence, 2 * index + 2);
+
+  /* Publish the line to the consumer. */
+  smp_store_release(&console_head, index + 1);
+
+  spin_unlock_irqrestore(&producer_lock, flags);
+
+  if (READ_ONCE(console_active)) {
+    irq_work_queue(&console_irq_work);
+  }
+  return true;
+}
+
+/**
+ * @brief Append one line to the console ring.
+ * @param p_text Text of the line, without newline.
+ * @param text_len Length of p_text, truncated to OLED_CONSOLE_LINE_LENGTH.
+ * @return None.
+ */
+void oled_console_push(const char *p_text, size_t text_len) {
+  oled_console_enqueue(p_text, text_len, false);
+}
+
+/**
+ * @brief Copy one line out of the ring.
+ * @param index Index of the line.
+ * @param p_text Buffer of OLED_CONSOLE_LINE_LENGTH bytes for the text.
+ * @param p_length Filled with the length of the text.
+ * @return true if the line was read intact, false if its slot was being
+ * overwritten by a newer line.
+ */
+static bool oled_console_read_slot(unsigned long index, char *p_text,
+                                   uint8_t *p_length) {
+  const oled_console_slot_t *p_slot =
+      &slots[index & (OLED_CONSOLE_SLOTS - 1)];
+  const unsigned long sequence = 2 * index + 2;
+
+  if (READ_ONCE(p_slot->sequence) != sequence) {
+    return false;
+  }
+  smp_rmb();
+  *p_length = min_t(uint8_t, READ_ONCE(p_slot->length),
+                    OLED_CONSOLE_LINE_LENGTH);
+  memcpy(p_text, p_slot->text, *p_length);
+  smp_rmb();
+  return READ_ONCE(p_slot->sequence) == sequence;
+}
+
+/**
+ * @brief irq_work handler deferring the drain to the next frame slot, so
+ * that all lines pushed until then are drawn at once.
+ * @param work Pointer to console_irq_work.
+ * @return None.
+ */
+static void oled_console_irq_work_handler(struct irq_work *work) {
+  queue_delayed_work(
+      system_freezable_wq, &console_work,
+      msecs_to_jiffies(MSEC_PER_SEC / oled_frame_get_max_fps()));
+}
+
+/**
+ * @brief Work handler drawing the tail of the ring.
+ * @param work Pointer to console_work.work.
+ * @return None.
+ */
+static void oled_console_work_handler(struct work_struct *work) {
+  char rows[OLED_CANVAS_MAX_LINES][OLED_CONSOLE_LINE_LENGTH];
+  uint8_t lengths[OLED_CANVAS_MAX_LINES];
+  unsigned long head, first, index;
+  unsigned int visible, tries;
+  uint8_t line;
+
+  if (!READ_ONCE(console_active)) {
+    return;
+  }
+
+  visible = READ_ONCE(oled_graphics_params.canvas_lines);
+
+  /* Only the lines that fit the canvas are read, older ones are skipped. */
+  for (tries = 0; tries < OLED_CONSOLE_READ_TRIES; ++tries) {
+    head = smp_load_acquire(&console_head);
+    if (head == console_drawn_head) {
+      return;
+    }
+
+    first = (head > visible) ? head - visible : 0;
+    for (index = first; index < head; ++index) {
+      if (!oled_console_read_slot(index, rows[index - first],
+                                  &lengths[index - first])) {
+        break;
+      }
+    }
+    if (index == head) {
+      break;
+    }
+  }
+
+  if (tries == OLED_CONSOLE_READ_TRIES) {
+    /* Producers lapped the ring meanwhile, try again next frame. */
+    irq_work_queue(&console_irq_work);
+    return;
+  }
+
+  console_drawn_head = head;
+
+  mutex_lock(&oled_graphics_lock);
+  for (line = 0; line < visible; ++line) {
+    oled_draw_text_span(line, 0, oled_graphics_params.canvas_columns - 1,
+                        rows[line], (line < head - first) ? lengths[line] : 0,
+                        OLED_ALIGN_LEFT, 1, false);
+  }
+  /* Regions stay on top of the console. */
+  oled_region_redraw_overlapping(0, visible - 1, 0,
+                                 oled_graphics_params.canvas_columns - 1);
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_frame_request_flush();
+}
+
+/**
+ * @brief Push the lines of a text, splitting it at newlines.
+ * @param p_text The text.
+ * @param text_len Length of p_text.
+ * @param may_drop true to drop lines on a contended producer_lock.
+ * @return None.
+ */
+static void oled_console_push_lines(const char *p_text, size_t text_len,
+                                    bool may_drop) {
+  const char *p_end = p_text + text_len;
+  const char *p_newline;
+
+  while (p_text < p_end) {
+    p_newline = memchr(p_text, '\n', p_end - p_text);
+    if (p_newline == NULL) {
+      p_newline = p_end;
+    }
+    oled_console_enqueue(p_text, p_newline - p_text, may_drop);
+    p_text = p_newline + 1;
+  }
+}
+
+/**
+ * @brief printk console write callback, mirroring kernel messages.
+ * @param console Pointer to oled_printk_console.
+ * @param p_text Message text.
+ * @param text_len Length of p_text.
+ * @return None.
+ * @note Never spins: a line is dropped while a /dev/oled_console writer holds
+ * producer_lock, which may be a CPU stopped by panic.
+ */
+static void oled_console_write(struct console *console, const char *p_text,
+                               unsigned int text_len) {
+  oled_console_push_lines(p_text, text_len, true);
+}
+
+/**
+ * @brief write() on /dev/oled_console: every line written is pushed into the
+ * ring, e.g. tail -f tool.log > /dev/oled_console.
+ * @param file Opened device file.
+ * @param p_buffer User buffer.
+ * @param count Length of p_buffer.
+ * @param p_offset Ignored.
+ * @return Number of bytes consumed, or -EFAULT.
+ * @note A line longer than OLED_CONSOLE_LINE_LENGTH is truncated. Text after
+ * the last newline is pushed as a line of its own.
+ */
+static ssize_t oled_console_dev_write(struct file *file,
+                                      const char __user *p_buffer,
+                                      size_t count, loff_t *p_offset) {
+  char chunk[OLED_CONSOLE_CHUNK_LENGTH];
+  char line[OLED_CONSOLE_LINE_LENGTH];
+  size_t line_len = 0;
+  size_t done, chunk_len, index;
+
+  for (done = 0; done < count; done += chunk_len) {
+    chunk_len = min_t(size_t, count - done, OLED_CONSOLE_CHUNK_LENGTH);
+    if (copy_from_user(chunk, p_buffer + done, chunk_len) != 0) {
+      return -EFAULT;
+    }
+
+    for (index = 0; index < chunk_len; ++index) {
+      if (chunk[index] == '\n') {
+        oled_console_push(line, line_len);
+        line_len = 0;
+      } else if ((chunk[index] != '\r') &&
+                 (line_len < OLED_CONSOLE_LINE_LENGTH)) {
+        line[line_len++] = chunk[index];
+      }
+    }
+  }
+
+  if (line_len > 0) {
+    oled_console_push(line, line_len);
+  }
+
+  return count;
+}
+
+/**
+ * @brief Start showing the tail of the console on the screen.
+ * @param None.
+ * @return 0.
+ */
+int oled_console_start(void) {
+  mutex_lock(&oled_graphics_lock);
+  oled_fill_all(0x00);
+  oled_region_redraw_overlapping(0, oled_graphics_params.canvas_lines - 1, 0,
+                                 oled_graphics_params.canvas_columns - 1);
+  mutex_unlock(&oled_graphics_lock);
+
+  /* Redraw the tail even if no line arrived since the last time. */
+  console_drawn_head = ULONG_MAX;
+  WRITE_ONCE(console_active, true);
+  queue_delayed_work(system_freezable_wq, &console_work, 0);
+  return 0;
+}
+
+/**
+ * @brief Stop showing the console and clear the canvas.
+ * @param None.
+ * @return None.
+ */
+void oled_console_stop(void) {
+  bool was_active = READ_ONCE(console_active);
+
+  WRITE_ONCE(console_active, false);
+  irq_work_sync(&console_irq_work);
+  cancel_delayed_work_sync(&console_work);
+
+  if (!was_active) {
+    return;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  oled_fill_all(0x00);
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_region_redraw_all();
+}
+
+/**
+ * @brief Mirror kernel log messages into the console.
+ * @param enable true to register the console with printk, false to
+ * unregister it.
+ * @return None.
+ */
+void oled_console_set_printk(bool enable) {
+  mutex_lock(&printk_console_lock);
+
+  if (enable && !printk_console_registered) {
+    register_console(&oled_printk_console);
+    printk_console_registered = true;
+  } else if (!enable && printk_console_registered) {
+    unregister_console(&oled_printk_console);
+    printk_console_registered = false;
+  }
+
+  mutex_unlock(&printk_console_lock);
+}
+
+/**
+ * @brief Check whether kernel log messages are mirrored.
+ * @param None.
+ * @return true if registered with printk.
+ */
+bool oled_console_get_printk(void) {
+  return READ_ONCE(printk_console_registered);
+}
+
+/**
+ * @brief Get the number of lines pushed since the module was loaded.
+ * @param None.
+ * @return Line count.
+ */
+unsigned long oled_console_get_lines(void) {
+  return smp_load_acquire(&console_head);
+}
+
+/**
+ * @brief Register /dev/oled_console.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_console_init(void) {
+  int status_code;
+
+  init_irq_work(&console_irq_work, oled_console_irq_work_handler);
+
+  status_code = misc_register(&oled_console_device);
+  oled_console_device_registered = (status_code == 0);
+  return status_code;
+}
+
+/**
+ * @brief Unregister /dev/oled_console and the printk console.
+ * @param None.
+ * @return None.
+ * @note Console mode has already been left by oled_sysfs_remove.
+ */
+void oled_console_deinit(void) {
+  oled_console_set_printk(false);
+  if (oled_console_device_registered) {
+    misc_deregister(&oled_console_device);
+    oled_console_device_registered = false;
+  }
+}
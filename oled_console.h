@@ -0,0 +1,79 @@
+/**
+ * @file oled_console.h
+ * @brief Log-tail console header: lines written to /dev/oled_console (and
+ * optionally printk) are shown as a scrolling tail on the oled screen.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_CONSOLE_H
+#define OLED_CONSOLE_H
+
+#include "graphics.h"
+
+/* Characters kept per line, the screen shows as many as fit the canvas. */
+#define OLED_CONSOLE_LINE_LENGTH 40
+/* Lines kept in the ring, a power of two larger than the lines on screen. */
+#define OLED_CONSOLE_SLOTS 64
+
+/**
+ * @brief Append one line to the console ring.
+ * @param p_text Text of the line, without newline.
+ * @param text_len Length of p_text, truncated to OLED_CONSOLE_LINE_LENGTH.
+ * @return None.
+ * @note Safe in any context, including atomic. Never waits on the I2C bus:
+ * the oldest line is overwritten when the ring is full.
+ */
+void oled_console_push(const char *p_text, size_t text_len);
+
+/**
+ * @brief Start showing the tail of the console on the screen.
+ * @param None.
+ * @return 0.
+ */
+int oled_console_start(void);
+
+/**
+ * @brief Stop showing the console and clear the canvas.
+ * @param None.
+ * @return None.
+ */
+void oled_console_stop(void);
+
+/**
+ * @brief Mirror kernel log messages into the console.
+ * @param enable true to register the console with printk, false to
+ * unregister it.
+ * @return None.
+ */
+void oled_console_set_printk(bool enable);
+
+/**
+ * @brief Check whether kernel log messages are mirrored.
+ * @param None.
+ * @return true if registered with printk.
+ */
+bool oled_console_get_printk(void);
+
+/**
+ * @brief Get the number of lines pushed since the module was loaded.
+ * @param None.
+ * @return Line count.
+ */
+unsigned long oled_console_get_lines(void);
+
+/**
+ * @brief Register /dev/oled_console.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_console_init(void);
+
+/**
+ * @brief Unregister /dev/oled_console and the printk console.
+ * @param None.
+ * @return None.
+ */
+void oled_console_deinit(void);
+
+#endif /* OLED_CONSOLE_H */
@@ -0,0 +1,570 @@
+/**
+ * @file oled_dashboard.c
+ * @brief Host metrics dashboard implementation. A layout uploaded once is
+ * drawn as static text, and a low-rate work item samples the kernel sources
+ * bound to its fields, re-rendering only the fields whose value changed.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_dashboard.h"
+#include "oled_frame.h"
+#include "oled_region.h"
+
+#include <linux/math64.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/netdevice.h>
+#include <linux/sched/loadavg.h>
+#include <linux/string.h>
+#include <linux/thermal.h>
+#include <linux/timekeeping.h>
+#include <linux/workqueue.h>
+
+/* Longest formatted value of a field. */
+#define OLED_DASHBOARD_VALUE_LENGTH 24
+/* Longest argument of a field, a thermal zone type or a netdev name. */
+#define OLED_DASHBOARD_ARG_LENGTH THERMAL_NAME_LENGTH
+
+/* Function signatures. */
+static void oled_dashboard_work_handler(struct work_struct *work);
+
+/**
+ * @brief Link the symbol to its spawn in graphics.c
+ */
+extern oled_graphics_params_t oled_graphics_params;
+
+/**
+ * @brief Enum type defining the kernel sources a field can be bound to.
+ */
+typedef enum {
+  OLED_SOURCE_LOAD1,
+  OLED_SOURCE_LOAD5,
+  OLED_SOURCE_LOAD15,
+  OLED_SOURCE_MEMFREE,
+  OLED_SOURCE_MEMAVAIL,
+  OLED_SOURCE_MEMUSED,
+  OLED_SOURCE_UPTIME,
+  OLED_SOURCE_TEMP,
+  OLED_SOURCE_RX,
+  OLED_SOURCE_TX,
+  OLED_SOURCE_LINK,
+  OLED_SOURCE_COUNT
+} oled_dashboard_source_t;
+
+/**
+ * @brief Names of the sources as written in a layout, and whether they take
+ * an argument.
+ */
+static const struct {
+  const char *name;
+  bool has_arg;
+} source_table[OLED_SOURCE_COUNT] = {
+    [OLED_SOURCE_LOAD1] = {"load1", false},
+    [OLED_SOURCE_LOAD5] = {"load5", false},
+    [OLED_SOURCE_LOAD15] = {"load15", false},
+    [OLED_SOURCE_MEMFREE] = {"memfree", false},
+    [OLED_SOURCE_MEMAVAIL] = {"memavail", false},
+    [OLED_SOURCE_MEMUSED] = {"memused", false},
+    [OLED_SOURCE_UPTIME] = {"uptime", false},
+    [OLED_SOURCE_TEMP] = {"temp", true},
+    [OLED_SOURCE_RX] = {"rx", true},
+    [OLED_SOURCE_TX] = {"tx", true},
+    [OLED_SOURCE_LINK] = {"link", true},
+};
+
+/**
+ * @brief Struct describing one field of the layout.
+ * @param source Kernel source the field shows.
+ * @param arg Thermal zone type or netdev name, empty if unused.
+ * @param line The line (page) of the field.
+ * @param column First character column of the field.
+ * @param width Width of the field in characters.
+ * @param value Value currently drawn, empty until first sampled.
+ * @param last_counter Byte counter at the previous sample, for rates.
+ * @param last_sample_ns Time of the previous sample, 0 before the first.
+ */
+typedef struct {
+  oled_dashboard_source_t source;
+  char arg[OLED_DASHBOARD_ARG_LENGTH];
+  uint8_t line;
+  uint8_t column;
+  uint8_t width;
+  char value[OLED_DASHBOARD_VALUE_LENGTH];
+  u64 last_counter;
+  u64 last_sample_ns;
+} oled_dashboard_field_t;
+
+/**
+ * @brief Struct holding a parsed layout.
+ * @param source The layout as uploaded.
+ * @param text Static text of each line, with the fields blanked out.
+ * @param line_count Number of lines of the layout.
+ * @param fields The fields of the layout.
+ * @param field_count Number of fields.
+ */
+typedef struct {
+  char source[OLED_DASHBOARD_LAYOUT_LENGTH];
+  char text[OLED_CANVAS_MAX_LINES][OLED_DASHBOARD_LINE_LENGTH + 1];
+  uint8_t line_count;
+  oled_dashboard_field_t fields[OLED_DASHBOARD_MAX_FIELDS];
+  uint8_t field_count;
+} oled_dashboard_layout_t;
+
+/**
+ * @brief The current layout, and the one being parsed. Protected by
+ * dashboard_lock.
+ */
+static oled_dashboard_layout_t layout;
+static oled_dashboard_layout_t staging;
+
+/**
+ * @brief Serializes layout changes, sampling and start / stop.
+ */
+static DEFINE_MUTEX(dashboard_lock);
+
+/**
+ * @brief true while the dashboard owns the screen.
+ */
+static bool dashboard_running;
+
+/**
+ * @brief Sampling period in milliseconds.
+ */
+static unsigned int dashboard_interval_ms = OLED_DASHBOARD_DEFAULT_INTERVAL_MS;
+
+/**
+ * @brief Delayed work sampling the sources.
+ */
+static DECLARE_DELAYED_WORK(dashboard_work, oled_dashboard_work_handler);
+
+/**
+ * @brief Parse one "{source}" or "{source:argument}" placeholder.
+ * @param p_field Field to fill in.
+ * @param p_spec Text between the braces.
+ * @param spec_len Length of p_spec.
+ * @return 0 on success, -EINVAL on an unknown source or a missing argument.
+ */
+static int oled_dashboard_parse_field(oled_dashboard_field_t *p_field,
+                                      const char *p_spec, size_t spec_len) {
+  size_t name_len = strcspn(p_spec, ":}");
+  size_t arg_len;
+  int source;
+
+  for (source = 0; source < OLED_SOURCE_COUNT; ++source) {
+    if ((strlen(source_table[source].name) == name_len) &&
+        (strncmp(source_table[source].name, p_spec, name_len) == 0)) {
+      break;
+    }
+  }
+  if (source == OLED_SOURCE_COUNT) {
+    return -EINVAL;
+  }
+
+  arg_len = (name_len < spec_len) ? spec_len - name_len - 1 : 0;
+  if (source_table[source].has_arg !=
+      ((arg_len > 0) && (arg_len < OLED_DASHBOARD_ARG_LENGTH))) {
+    return -EINVAL;
+  }
+
+  memset(p_field, 0, sizeof(oled_dashboard_field_t));
+  p_field->source = source;
+  if (arg_len > 0) {
+    memcpy(p_field->arg, p_spec + name_len + 1, arg_len);
+  }
+  return 0;
+}
+
+/**
+ * @brief Parse a layout into staging.
+ * @param p_layout The layout.
+ * @param layout_len Length of p_layout.
+ * @return 0 on success, negative errno otherwise.
+ * @note Caller must hold dashboard_lock.
+ */
+static int oled_dashboard_parse(const char *p_layout, size_t layout_len) {
+  oled_dashboard_field_t *p_field;
+  const char *p_close;
+  size_t column, spec_len;
+  uint8_t line = 0;
+  char *p_text;
+  int status_code;
+
+  memset(&staging, 0, sizeof(oled_dashboard_layout_t));
+  memcpy(staging.source, p_layout, layout_len);
+
+  p_layout = staging.source;
+  while ((*p_layout != '\0') && (line < OLED_CANVAS_MAX_LINES)) {
+    p_text = staging.text[line];
+
+    for (column = 0; (*p_layout != '\0') && (*p_layout != '\n');
+         ++p_layout, ++column) {
+      p_close = (*p_layout == '{') ? strpbrk(p_layout, "}\n") : NULL;
+
+      if ((p_close == NULL) || (*p_close != '}')) {
+        if (column < OLED_DASHBOARD_LINE_LENGTH) {
+          p_text[column] = *p_layout;
+        }
+        continue;
+      }
+
+      if (staging.field_count == OLED_DASHBOARD_MAX_FIELDS) {
+        return -ENOSPC;
+      }
+
+      p_field = &staging.fields[staging.field_count];
+      spec_len = p_close - p_layout - 1;
+      status_code = oled_dashboard_parse_field(p_field, p_layout + 1, spec_len);
+      if (status_code != 0) {
+        return status_code;
+      }
+
+      /* The field takes the place of its placeholder, braces included. */
+      p_field->line = line;
+      p_field->column = min_t(size_t, column, OLED_DASHBOARD_LINE_LENGTH);
+      p_field->width = spec_len + 2;
+      staging.field_count += 1;
+
+      for (; p_layout < p_close; ++p_layout, ++column) {
+        if (column < OLED_DASHBOARD_LINE_LENGTH) {
+          p_text[column] = ' ';
+        }
+      }
+      if (column < OLED_DASHBOARD_LINE_LENGTH) {
+        p_text[column] = ' ';
+      }
+    }
+
+    if (*p_layout == '\n') {
+      ++p_layout;
+    }
+    line += 1;
+  }
+
+  staging.line_count = line;
+  return 0;
+}
+
+/**
+ * @brief Draw the value of one field.
+ * @param p_field The field.
+ * @return None.
+ * @note Caller must hold dashboard_lock and oled_graphics_lock.
+ */
+static void oled_dashboard_draw_field(const oled_dashboard_field_t *p_field) {
+  const unsigned int first_position = p_field->column * OLED_FONT_CHAR_WIDTH;
+  const unsigned int last_position = min_t(
+      unsigned int, first_position + p_field->width * OLED_FONT_CHAR_WIDTH - 1,
+      oled_graphics_params.canvas_columns - 1);
+
+  if (first_position >= oled_graphics_params.canvas_columns) {
+    return;
+  }
+
+  oled_draw_text_span(p_field->line, first_position, last_position,
+                      p_field->value, strlen(p_field->value), OLED_ALIGN_LEFT,
+                      1, false);
+
+  /* Regions stay on top of the dashboard. */
+  oled_region_redraw_overlapping(p_field->line, p_field->line, first_position,
+                                 last_position);
+}
+
+/**
+ * @brief Clear the canvas and draw the static text of the layout. Fields are
+ * drawn once they are sampled.
+ * @param None.
+ * @return None.
+ * @note Caller must hold dashboard_lock.
+ */
+static void oled_dashboard_draw_layout(void) {
+  uint8_t line;
+  uint8_t field;
+
+  mutex_lock(&oled_graphics_lock);
+
+  oled_fill_all(0x00);
+  for (line = 0; line < layout.line_count; ++line) {
+    oled_draw_text_span(line, 0, oled_graphics_params.canvas_columns - 1,
+                        layout.text[line], strlen(layout.text[line]),
+                        OLED_ALIGN_LEFT, 1, false);
+  }
+
+  /* Force every field to be drawn at the next sample. */
+  for (field = 0; field < layout.field_count; ++field) {
+    layout.fields[field].value[0] = '\0';
+  }
+
+  /* Regions stay on top of the dashboard. */
+  oled_region_redraw_overlapping(0, oled_graphics_params.canvas_lines - 1, 0,
+                                 oled_graphics_params.canvas_columns - 1);
+
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_frame_request_flush();
+}
+
+/**
+ * @brief Format the value of a per-second byte rate of a netdev counter.
+ * @param p_field The field, keeping the previous counter.
+ * @param counter The current counter.
+ * @param p_value Buffer to format the value into.
+ * @return None.
+ */
+static void oled_dashboard_format_rate(oled_dashboard_field_t *p_field,
+                                       u64 counter, char *p_value) {
+  u64 now_ns = ktime_get_ns();
+  u64 elapsed_us = div_u64(now_ns - p_field->last_sample_ns, NSEC_PER_USEC);
+  u64 rate = 0;
+
+  if ((p_field->last_sample_ns != 0) && (elapsed_us != 0) &&
+      (counter >= p_field->last_counter)) {
+    rate = div64_u64((counter - p_field->last_counter) * USEC_PER_SEC,
+                     elapsed_us);
+  }
+  p_field->last_counter = counter;
+  p_field->last_sample_ns = now_ns;
+
+  snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%lluK",
+           (unsigned long long)(rate >> 10));
+}
+
+/**
+ * @brief Sample the source of one field.
+ * @param p_field The field.
+ * @param p_value Buffer to format the value into, OLED_DASHBOARD_VALUE_LENGTH
+ * bytes.
+ * @return None.
+ * @note Unavailable sources (e.g. an absent netdev) read "--".
+ */
+static void oled_dashboard_sample(oled_dashboard_field_t *p_field,
+                                  char *p_value) {
+  struct thermal_zone_device *p_zone;
+  struct rtnl_link_stats64 stats;
+  struct net_device *p_netdev;
+  struct sysinfo info;
+  unsigned long load;
+  time64_t uptime;
+  int temperature;
+
+  strscpy(p_value, "--", OLED_DASHBOARD_VALUE_LENGTH);
+
+  switch (p_field->source) {
+  case OLED_SOURCE_LOAD1:
+  case OLED_SOURCE_LOAD5:
+  case OLED_SOURCE_LOAD15:
+    /* Rounded to two decimals, like /proc/loadavg. */
+    load = avenrun[p_field->source - OLED_SOURCE_LOAD1] + FIXED_1 / 200;
+    snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%lu.%02lu",
+             LOAD_INT(load), LOAD_FRAC(load));
+    break;
+  case OLED_SOURCE_MEMFREE:
+  case OLED_SOURCE_MEMUSED:
+    si_meminfo(&info);
+    snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%luM",
+             ((p_field->source == OLED_SOURCE_MEMFREE)
+                  ? info.freeram
+                  : info.totalram - si_mem_available()) >>
+                 (20 - PAGE_SHIFT));
+    break;
+  case OLED_SOURCE_MEMAVAIL:
+    snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%luM",
+             (unsigned long)si_mem_available() >> (20 - PAGE_SHIFT));
+    break;
+  case OLED_SOURCE_UPTIME:
+    uptime = ktime_get_boottime_seconds();
+    snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%lld:%02lld",
+             (long long)(uptime / 3600), (long long)(uptime / 60 % 60));
+    break;
+  case OLED_SOURCE_TEMP:
+    p_zone = thermal_zone_get_zone_by_name(p_field->arg);
+    if (!IS_ERR(p_zone) && (thermal_zone_get_temp(p_zone, &temperature) == 0)) {
+      /* The sign is printed apart, -500 would read 0.5C otherwise. */
+      snprintf(p_value, OLED_DASHBOARD_VALUE_LENGTH, "%s%d.%dC",
+               (temperature < 0) ? "-" : "", abs(temperature) / 1000,
+               abs(temperature) % 1000 / 100);
+    }
+    break;
+  case OLED_SOURCE_RX:
+  case OLED_SOURCE_TX:
+  case OLED_SOURCE_LINK:
+    p_netdev = dev_get_by_name(&init_net, p_field->arg);
+    if (p_netdev == NULL) {
+      break;
+    }
+    if (p_field->source == OLED_SOURCE_LINK) {
+      strscpy(p_value,
+              (netif_running(p_netdev) && netif_carrier_ok(p_netdev)) ? "up"
+                                                                      : "down",
+              OLED_DASHBOARD_VALUE_LENGTH);
+    } else {
+      dev_get_stats(p_netdev, &stats);
+      oled_dashboard_format_rate(p_field,
+                                 (p_field->source == OLED_SOURCE_RX)
+                                     ? stats.rx_bytes
+                                     : stats.tx_bytes,
+                                 p_value);
+    }
+    dev_put(p_netdev);
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Work handler sampling all fields and redrawing the changed ones.
+ * @param work Pointer to dashboard_work.work.
+ * @return None.
+ */
+static void oled_dashboard_work_handler(struct work_struct *work) {
+  char values[OLED_DASHBOARD_MAX_FIELDS][OLED_DASHBOARD_VALUE_LENGTH];
+  bool changed = false;
+  uint8_t field;
+
+  mutex_lock(&dashboard_lock);
+
+  if (!dashboard_running) {
+    goto RETURN;
+  }
+
+  /* Sample first, the sources may sleep. */
+  for (field = 0; field < layout.field_count; ++field) {
+    oled_dashboard_sample(&layout.fields[field], values[field]);
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  for (field = 0; field < layout.field_count; ++field) {
+    if (strcmp(values[field], layout.fields[field].value) != 0) {
+      strscpy(layout.fields[field].value, values[field],
+              OLED_DASHBOARD_VALUE_LENGTH);
+      oled_dashboard_draw_field(&layout.fields[field]);
+      changed = true;
+    }
+  }
+  mutex_unlock(&oled_graphics_lock);
+
+  queue_delayed_work(system_freezable_wq, &dashboard_work,
+                     msecs_to_jiffies(READ_ONCE(dashboard_interval_ms)));
+
+RETURN:
+  mutex_unlock(&dashboard_lock);
+
+  if (changed) {
+    oled_frame_request_flush();
+  }
+}
+
+/**
+ * @brief Parse and store a layout.
+ * @param p_layout The layout, see oled_dashboard.h.
+ * @param layout_len Length of p_layout.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_dashboard_set_layout(const char *p_layout, size_t layout_len) {
+  int status_code;
+
+  if (layout_len >= OLED_DASHBOARD_LAYOUT_LENGTH) {
+    return -E2BIG;
+  }
+
+  mutex_lock(&dashboard_lock);
+
+  status_code = oled_dashboard_parse(p_layout, layout_len);
+  if (status_code == 0) {
+    memcpy(&layout, &staging, sizeof(oled_dashboard_layout_t));
+    if (dashboard_running) {
+      oled_dashboard_draw_layout();
+      mod_delayed_work(system_freezable_wq, &dashboard_work, 0);
+    }
+  }
+
+  mutex_unlock(&dashboard_lock);
+
+  return status_code;
+}
+
+/**
+ * @brief Get the layout as uploaded.
+ * @param p_layout Filled with the NUL terminated layout,
+ * OLED_DASHBOARD_LAYOUT_LENGTH bytes.
+ * @return None.
+ */
+void oled_dashboard_get_layout(char *p_layout) {
+  mutex_lock(&dashboard_lock);
+  memcpy(p_layout, layout.source, OLED_DASHBOARD_LAYOUT_LENGTH);
+  mutex_unlock(&dashboard_lock);
+}
+
+/**
+ * @brief Draw the layout and start sampling its sources.
+ * @param None.
+ * @return 0 on success, -ENODATA if no layout has been set.
+ */
+int oled_dashboard_start(void) {
+  int status_code = 0;
+
+  mutex_lock(&dashboard_lock);
+
+  if (layout.line_count == 0) {
+    status_code = -ENODATA;
+    goto RETURN;
+  }
+
+  dashboard_running = true;
+  oled_dashboard_draw_layout();
+  queue_delayed_work(system_freezable_wq, &dashboard_work, 0);
+
+RETURN:
+  mutex_unlock(&dashboard_lock);
+
+  return status_code;
+}
+
+/**
+ * @brief Stop sampling and clear the canvas.
+ * @param None.
+ * @return None.
+ */
+void oled_dashboard_stop(void) {
+  bool was_running;
+
+  mutex_lock(&dashboard_lock);
+  was_running = dashboard_running;
+  dashboard_running = false;
+  mutex_unlock(&dashboard_lock);
+
+  /* Not under dashboard_lock, which the work handler takes. */
+  cancel_delayed_work_sync(&dashboard_work);
+
+  if (!was_running) {
+    return;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  oled_fill_all(0x00);
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_region_redraw_all();
+}
+
+/**
+ * @brief Set the sampling period.
+ * @param interval_ms Milliseconds, clamped to OLED_DASHBOARD_MIN_INTERVAL_MS..
+ * OLED_DASHBOARD_MAX_INTERVAL_MS.
+ * @return None.
+ */
+void oled_dashboard_set_interval(unsigned int interval_ms) {
+  WRITE_ONCE(dashboard_interval_ms,
+             clamp_val(interval_ms, OLED_DASHBOARD_MIN_INTERVAL_MS,
+                       OLED_DASHBOARD_MAX_INTERVAL_MS));
+}
+
+/**
+ * @brief Get the sampling period.
+ * @param None.
+ * @return Milliseconds.
+ */
+unsigned int oled_dashboard_get_interval(void) {
+  return READ_ONCE(dashboard_interval_ms);
+}
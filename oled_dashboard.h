@@ -0,0 +1,77 @@
+/**
+ * @file oled_dashboard.h
+ * @brief Host metrics dashboard header: a text layout whose fields are bound
+ * to kernel sources and refreshed in the driver.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_DASHBOARD_H
+#define OLED_DASHBOARD_H
+
+#include "graphics.h"
+
+/* Size of a layout, as uploaded. */
+#define OLED_DASHBOARD_LAYOUT_LENGTH 512
+/* Characters kept per layout line, longer lines are clipped by the canvas. */
+#define OLED_DASHBOARD_LINE_LENGTH 32
+#define OLED_DASHBOARD_MAX_FIELDS 16
+
+/* Sampling period of the bound sources. */
+#define OLED_DASHBOARD_DEFAULT_INTERVAL_MS 1000
+#define OLED_DASHBOARD_MIN_INTERVAL_MS 100
+#define OLED_DASHBOARD_MAX_INTERVAL_MS 60000
+
+/**
+ * @brief Parse and store a layout.
+ * @param p_layout One line of text per line (page) of the canvas. A field
+ * "{source}" or "{source:argument}" is replaced by the current value of the
+ * source, left aligned and clipped to the width of the placeholder itself.
+ * Sources: load1, load5, load15, memfree, memavail, memused, uptime,
+ * temp:<thermal zone type>, rx:<netdev>, tx:<netdev>, link:<netdev>.
+ * @param layout_len Length of p_layout.
+ * @return 0 on success, -EINVAL on an unknown source or a missing argument,
+ * -ENOSPC on more than OLED_DASHBOARD_MAX_FIELDS fields, -E2BIG on a layout
+ * longer than OLED_DASHBOARD_LAYOUT_LENGTH - 1.
+ * @note A running dashboard is redrawn with the new layout.
+ */
+int oled_dashboard_set_layout(const char *p_layout, size_t layout_len);
+
+/**
+ * @brief Get the layout as uploaded.
+ * @param p_layout Filled with the NUL terminated layout,
+ * OLED_DASHBOARD_LAYOUT_LENGTH bytes.
+ * @return None.
+ */
+void oled_dashboard_get_layout(char *p_layout);
+
+/**
+ * @brief Draw the layout and start sampling its sources.
+ * @param None.
+ * @return 0 on success, -ENODATA if no layout has been set.
+ */
+int oled_dashboard_start(void);
+
+/**
+ * @brief Stop sampling and clear the canvas.
+ * @param None.
+ * @return None.
+ */
+void oled_dashboard_stop(void);
+
+/**
+ * @brief Set the sampling period.
+ * @param interval_ms Milliseconds, clamped to OLED_DASHBOARD_MIN_INTERVAL_MS..
+ * OLED_DASHBOARD_MAX_INTERVAL_MS.
+ * @return None.
+ */
+void oled_dashboard_set_interval(unsigned int interval_ms);
+
+/**
+ * @brief Get the sampling period.
+ * @param None.
+ * @return Milliseconds.
+ */
+unsigned int oled_dashboard_get_interval(void);
+
+#endif /* OLED_DASHBOARD_H */
@@ -0,0 +1,241 @@
+/**
+ * @file oled_frame.c
+ * @brief Frame pacing scheduler implementation. Render paths only touch the
+ * shadow buffer and request a flush; this file decides when the changed spans
+ * are written to the SSD1306 OLED and notifies user space once they are.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_frame.h"
+#include "graphics.h"
+
+#include <linux/i2c.h>
+#include <linux/jiffies.h>
+#include <linux/kobject.h>
+#include <linux/pm_runtime.h>
+#include <linux/sysfs.h>
+#include <linux/workqueue.h>
+
+/* Function signatures. */
+static void oled_frame_work_handler(struct work_struct *work);
+
+/**
+ * @brief Link the symbol to its spawn in oled_sysfs.c
+ */
+extern struct kobject *oled_kobj;
+
+/**
+ * @brief Link the symbol to its spawn in driver.c
+ */
+extern struct i2c_client *i2c_client;
+
+/**
+ * @brief Delayed work flushing the shadow buffer at the next frame slot.
+ */
+static DECLARE_DELAYED_WORK(oled_frame_work, oled_frame_work_handler);
+
+/**
+ * @brief Upper bound of frames per second written to the screen.
+ */
+static unsigned int oled_frame_max_fps = OLED_FRAME_DEFAULT_MAX_FPS;
+
+/**
+ * @brief Jiffies timestamp of the last completed flush.
+ */
+static unsigned long oled_frame_last_flush;
+
+/**
+ * @brief Sequence number of the last frame that reached the screen.
+ */
+static u32 oled_frame_sequence;
+
+/**
+ * @brief Set when the controller has to be initialized again before the next
+ * flush, i.e. after it failed to respond.
+ */
+static bool oled_frame_reinit_pending;
+
+/**
+ * @brief Set while another path (e.g. grayscale bitplane cycling) owns the
+ * screen. The shadow buffer keeps collecting changes but is not flushed.
+ */
+static bool oled_frame_hold;
+
+/**
+ * @brief Request the shadow buffer to be flushed to the oled screen.
+ * @param None.
+ * @return None.
+ */
+void oled_frame_request_flush(void) {
+  unsigned long interval =
+      msecs_to_jiffies(MSEC_PER_SEC / READ_ONCE(oled_frame_max_fps));
+  unsigned long next_slot = READ_ONCE(oled_frame_last_flush) + interval;
+  unsigned long delay = 0;
+
+  if (time_before(jiffies, next_slot)) {
+    delay = next_slot - jiffies;
+  }
+
+  /* No-op if a flush is already pending, which coalesces the updates. The
+   * freezable workqueue keeps flushes off the bus over system suspend. */
+  queue_delayed_work(system_freezable_wq, &oled_frame_work, delay);
+}
+
+/**
+ * @brief Work handler writing the changed spans of the shadow buffer to the
+ * screen and notifying pollers of the frame_sequence attribute.
+ * @param work Pointer to oled_frame_work.
+ * @return None.
+ * @note The device is runtime resumed for the flush only when there is
+ * something to write, so an unchanged screen can autosuspend.
+ */
+static void oled_frame_work_handler(struct work_struct *work) {
+  struct device *dev = &i2c_client->dev;
+  unsigned long interval;
+  bool pending;
+  int pm_status;
+  int status_code;
+
+  if (READ_ONCE(oled_frame_hold)) {
+    return;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  pending = READ_ONCE(oled_frame_reinit_pending) || ssd1306_is_degraded() ||
+            oled_has_dirty();
+  mutex_unlock(&oled_graphics_lock);
+
+  if (!pending) {
+    return;
+  }
+
+  /* Resuming restores the whole frame, see oled_pm_resume. */
+  pm_status = pm_runtime_get_sync(dev);
+  if (pm_status < 0) {
+    pm_runtime_put_noidle(dev);
+    status_code = pm_status;
+    goto RETRY;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+
+  /* The panel may have lost power while it was unreachable. */
+  if (ssd1306_is_degraded()) {
+    oled_frame_reinit_pending = true;
+  }
+
+  if (READ_ONCE(oled_frame_reinit_pending)) {
+    status_code = ssd1306_controller_init();
+    if (0 == status_code) {
+      WRITE_ONCE(oled_frame_reinit_pending, false);
+      status_code = oled_flush_frame();
+    }
+    if (0 == status_code) {
+      status_code = 1;
+    }
+  } else {
+    status_code = oled_flush_dirty();
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  pm_runtime_mark_last_busy(dev);
+  pm_runtime_put_autosuspend(dev);
+
+  /* The changes already went out with the frame restored on resume. */
+  if ((0 == status_code) && (0 == pm_status)) {
+    status_code = 1;
+  }
+
+RETRY:
+  if (status_code < 0) {
+    /* The failed spans are still dirty, try again one frame (or one degraded
+     * probe period) later instead of spinning on the bus. */
+    interval = ssd1306_is_degraded()
+                   ? msecs_to_jiffies(SSD1306_DEGRADED_PROBE_MS)
+                   : msecs_to_jiffies(MSEC_PER_SEC /
+                                      READ_ONCE(oled_frame_max_fps));
+    queue_delayed_work(system_freezable_wq, &oled_frame_work, interval);
+    return;
+  }
+
+  if (0 == status_code) {
+    return;
+  }
+
+  WRITE_ONCE(oled_frame_last_flush, jiffies);
+  WRITE_ONCE(oled_frame_sequence, oled_frame_sequence + 1);
+
+  /* Wake up poll() / select() waiters on the frame_sequence attribute. */
+  if (oled_kobj) {
+    sysfs_notify(oled_kobj, NULL, "frame_sequence");
+  }
+}
+
+/**
+ * @brief Initialize the controller again and restore the whole frame at the
+ * next frame slot.
+ * @param None.
+ * @return None.
+ */
+void oled_frame_request_reinit(void) {
+  WRITE_ONCE(oled_frame_reinit_pending, true);
+  oled_frame_request_flush();
+}
+
+/**
+ * @brief Stop / resume flushing the shadow buffer to the screen.
+ * @param hold true to stop flushing, false to resume.
+ * @return None.
+ */
+void oled_frame_set_hold(bool hold) {
+  WRITE_ONCE(oled_frame_hold, hold);
+
+  if (hold) {
+    cancel_delayed_work_sync(&oled_frame_work);
+  } else {
+    /* Whoever held the screen may have changed any controller setting. */
+    oled_frame_request_reinit();
+  }
+}
+
+/**
+ * @brief Check whether another path owns the screen.
+ * @param None.
+ * @return true while flushing is held by oled_frame_set_hold.
+ */
+bool oled_frame_is_held(void) { return READ_ONCE(oled_frame_hold); }
+
+/**
+ * @brief Set the maximum number of frames per second flushed to the screen.
+ * @param max_fps Frame rate, clamped to OLED_FRAME_MIN_FPS..OLED_FRAME_MAX_FPS.
+ * @return None.
+ */
+void oled_frame_set_max_fps(unsigned int max_fps) {
+  WRITE_ONCE(oled_frame_max_fps,
+             clamp_val(max_fps, OLED_FRAME_MIN_FPS, OLED_FRAME_MAX_FPS));
+}
+
+/**
+ * @brief Get the maximum number of frames per second flushed to the screen.
+ * @param None.
+ * @return Frame rate.
+ */
+unsigned int oled_frame_get_max_fps(void) {
+  return READ_ONCE(oled_frame_max_fps);
+}
+
+/**
+ * @brief Get the sequence number of the last frame that reached the screen.
+ * @param None.
+ * @return Frame sequence number.
+ */
+u32 oled_frame_get_sequence(void) { return READ_ONCE(oled_frame_sequence); }
+
+/**
+ * @brief Cancel any pending flush. Called before the device goes away.
+ * @param None.
+ * @return None.
+ */
+void oled_frame_deinit(void) { cancel_delayed_work_sync(&oled_frame_work); }
@@ -0,0 +1,80 @@
+/**
+ * @file oled_frame.h
+ * @brief Frame pacing scheduler header, flushing the shadow buffer to the
+ * SSD1306 OLED at a bounded frame rate.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_FRAME_H
+#define OLED_FRAME_H
+
+#include <linux/types.h>
+
+#define OLED_FRAME_DEFAULT_MAX_FPS 30
+#define OLED_FRAME_MIN_FPS 1
+#define OLED_FRAME_MAX_FPS 120
+
+/**
+ * @brief Request the shadow buffer to be flushed to the oled screen.
+ * @param None.
+ * @return None.
+ * @note Requests arriving within one frame interval of the previous flush are
+ * coalesced into a single flush at the start of the next frame slot.
+ */
+void oled_frame_request_flush(void);
+
+/**
+ * @brief Initialize the controller again and restore the whole frame at the
+ * next frame slot.
+ * @param None.
+ * @return None.
+ * @note Used when the controller failed to respond, retried with backoff.
+ */
+void oled_frame_request_reinit(void);
+
+/**
+ * @brief Stop / resume flushing the shadow buffer to the screen.
+ * @param hold true to stop flushing, false to resume.
+ * @return None.
+ * @note Drawing into the shadow buffer continues while held. Resuming
+ * re-initializes the controller and restores the whole frame.
+ */
+void oled_frame_set_hold(bool hold);
+
+/**
+ * @brief Check whether another path owns the screen.
+ * @param None.
+ * @return true while flushing is held by oled_frame_set_hold.
+ */
+bool oled_frame_is_held(void);
+
+/**
+ * @brief Set the maximum number of frames per second flushed to the screen.
+ * @param max_fps Frame rate, clamped to OLED_FRAME_MIN_FPS..OLED_FRAME_MAX_FPS.
+ * @return None.
+ */
+void oled_frame_set_max_fps(unsigned int max_fps);
+
+/**
+ * @brief Get the maximum number of frames per second flushed to the screen.
+ * @param None.
+ * @return Frame rate.
+ */
+unsigned int oled_frame_get_max_fps(void);
+
+/**
+ * @brief Get the sequence number of the last frame that reached the screen.
+ * @param None.
+ * @return Frame sequence number, incremented on every completed flush.
+ */
+u32 oled_frame_get_sequence(void);
+
+/**
+ * @brief Cancel any pending flush. Called before the device goes away.
+ * @param None.
+ * @return None.
+ */
+void oled_frame_deinit(void);
+
+#endif /* OLED_FRAME_H */
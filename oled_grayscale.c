@@ -0,0 +1,448 @@
+/**
+ * @file oled_grayscale.c
+ * @brief Temporal grayscale (frame-rate modulation) rendering implementation.
+ * A 2bpp or 4bpp source image is converted once into 1bpp bitplanes in the
+ * controller's page-major layout, which a dedicated thread then writes to the
+ * screen back to back at a steady rate.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_grayscale.h"
+#include "oled_frame.h"
+
+#include <linux/delay.h>
+#include <linux/freezer.h>
+#include <linux/i2c.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/pm_runtime.h>
+#include <linux/sched.h>
+
+/* Extra microseconds usleep_range may take to coalesce wake-ups. */
+#define OLED_GRAYSCALE_SLACK_US 50
+
+/* Function signatures. */
+static int oled_grayscale_thread(void *parameters);
+
+/**
+ * @brief Link the symbol to its spawn in graphics.c
+ */
+extern oled_graphics_params_t oled_graphics_params;
+
+/**
+ * @brief Link the symbol to its spawn in driver.c
+ */
+extern struct i2c_client *i2c_client;
+
+/**
+ * @brief Precomputed bitplanes, each one complete subframe in GDDRAM layout.
+ */
+static u8 planes[OLED_GRAYSCALE_MAX_PLANES][OLED_FRAME_LENGTH];
+
+/**
+ * @brief SET_CONTRAST_CONTROL value sent with each bitplane when the planes
+ * are contrast weighted.
+ */
+static u8 plane_contrast[OLED_GRAYSCALE_MAX_PLANES];
+
+/**
+ * @brief Scratch frame for transposing portrait bitplanes.
+ */
+static u8 transpose_scratch[OLED_FRAME_LENGTH];
+
+/**
+ * @brief Number of valid bitplanes, 0 until an image has been loaded.
+ */
+static u8 plane_count;
+
+/**
+ * @brief Canvas size the bitplanes were built for. A portrait canvas, i.e. a
+ * rotation by 90 or 270 degrees, or another panel size needs another layout.
+ */
+static unsigned int plane_canvas_columns;
+static unsigned int plane_canvas_lines;
+
+/**
+ * @brief Selection for the next image loaded.
+ */
+static bool grayscale_weighted;
+
+/**
+ * @brief Bits per pixel of the next image loaded.
+ */
+static u8 grayscale_depth = OLED_GRAYSCALE_DEFAULT_DEPTH;
+
+/**
+ * @brief Target subframes per second, 0 for as fast as possible.
+ */
+static unsigned int grayscale_rate = OLED_GRAYSCALE_DEFAULT_RATE;
+
+/**
+ * @brief Statistics of the running thread, and the accumulators behind them.
+ */
+static oled_grayscale_stats_t grayscale_stats;
+static u64 flush_us_total;
+static ktime_t window_start;
+static u32 window_subframes;
+
+/**
+ * @brief Protects the bitplanes and the statistics.
+ */
+static DEFINE_MUTEX(grayscale_lock);
+
+/**
+ * @brief Points to the oled_grayscale_thread while grayscale runs.
+ */
+static struct task_struct *handle_grayscale_thread;
+
+/**
+ * @brief Read one pixel level out of a packed row-major source image.
+ * @param p_image Source image.
+ * @param bits_per_pixel 2 or 4.
+ * @param width Width of the image in pixels.
+ * @param x Pixel column.
+ * @param y Pixel row.
+ * @return The pixel level.
+ */
+static inline u8 oled_grayscale_pixel(const u8 *p_image, u8 bits_per_pixel,
+                                      unsigned int width, unsigned int x,
+                                      unsigned int y) {
+  const unsigned int pixels_per_byte = BITS_PER_BYTE / bits_per_pixel;
+  const unsigned int index = y * width + x;
+  const unsigned int shift =
+      (pixels_per_byte - 1 - index % pixels_per_byte) * bits_per_pixel;
+
+  return (p_image[index / pixels_per_byte] >> shift) &
+         ((1 << bits_per_pixel) - 1);
+}
+
+/**
+ * @brief Convert a 2bpp or 4bpp source image into precomputed bitplanes.
+ * @param p_image Source image.
+ * @param image_len Length of the source image, must match the selected depth.
+ * @return 0 on success, -EINVAL if image_len does not match the depth.
+ * @note Thermometer coding lights a pixel of level L in the first L of the
+ * (levels - 1) subframes. Weighted coding shows bit k of the level in
+ * subframe k, with a contrast halving for every less significant bit. The
+ * image is laid out in the current canvas orientation, i.e. 64 pixels wide
+ * when rotated by 90 or 270 degrees.
+ */
+int oled_grayscale_load(const u8 *p_image, size_t image_len) {
+  unsigned int line, position, bit, plane;
+  u8 bits_per_pixel = READ_ONCE(grayscale_depth);
+  u8 level, count;
+  bool weighted = READ_ONCE(grayscale_weighted);
+  unsigned int canvas_columns, canvas_lines, panel_columns;
+  size_t frame_length;
+  u8 *p_slice;
+
+  mutex_lock(&oled_graphics_lock);
+  canvas_columns = oled_graphics_params.canvas_columns;
+  canvas_lines = oled_graphics_params.canvas_lines;
+  panel_columns = oled_graphics_params.panel_columns;
+  frame_length = oled_frame_length();
+  mutex_unlock(&oled_graphics_lock);
+
+  if (image_len != frame_length * bits_per_pixel) {
+    return -EINVAL;
+  }
+
+  count = weighted ? bits_per_pixel : (1 << bits_per_pixel) - 1;
+
+  mutex_lock(&grayscale_lock);
+
+  memset(planes, 0, sizeof(planes));
+
+  for (plane = 0; plane < count; ++plane) {
+    plane_contrast[plane] =
+        weighted ? (0xFF >> (bits_per_pixel - 1 - plane)) : DEFAULT_CONTRAST;
+  }
+
+  for (line = 0; line < canvas_lines; ++line) {
+    for (position = 0; position < canvas_columns; ++position) {
+      for (bit = 0; bit < BITS_PER_BYTE; ++bit) {
+        level = oled_grayscale_pixel(p_image, bits_per_pixel, canvas_columns,
+                                     position, line * BITS_PER_BYTE + bit);
+        for (plane = 0; plane < count; ++plane) {
+          if (weighted ? (level & (1 << plane)) : (plane < level)) {
+            p_slice = &planes[plane][line * canvas_columns + position];
+            *p_slice |= 1 << bit;
+          }
+        }
+      }
+    }
+  }
+
+  /* Portrait planes are turned into panel orientation once, here. */
+  if (canvas_columns != panel_columns) {
+    for (plane = 0; plane < count; ++plane) {
+      oled_transpose_frame(planes[plane], transpose_scratch);
+      memcpy(planes[plane], transpose_scratch, frame_length);
+    }
+  }
+
+  plane_count = count;
+  plane_canvas_columns = canvas_columns;
+  plane_canvas_lines = canvas_lines;
+
+  mutex_unlock(&grayscale_lock);
+
+  return 0;
+}
+
+/**
+ * @brief Book-keep the time one subframe took to write.
+ * @param flush_us Duration of the write in microseconds.
+ * @return None.
+ * @note Caller must hold grayscale_lock.
+ */
+static void oled_grayscale_account(s64 flush_us) {
+  ktime_t now = ktime_get();
+  s64 window_us;
+
+  grayscale_stats.subframes += 1;
+  flush_us_total += flush_us;
+  grayscale_stats.flush_us_avg =
+      div64_u64(flush_us_total, grayscale_stats.subframes);
+  grayscale_stats.flush_us_max =
+      max_t(u32, grayscale_stats.flush_us_max, flush_us);
+
+  window_subframes += 1;
+  window_us = ktime_us_delta(now, window_start);
+  if (window_us >= USEC_PER_SEC) {
+    grayscale_stats.subframes_per_sec =
+        div64_u64((u64)window_subframes * USEC_PER_SEC, window_us);
+    window_subframes = 0;
+    window_start = now;
+  }
+}
+
+/**
+ * @brief Thread writing the bitplanes to the screen, one per subframe.
+ * @param None.
+ * @return 0.
+ * @note Each subframe is one batch: the plane contrast, a full-screen
+ * address window and the plane. Subframes are paced against absolute
+ * deadlines so the modulation does not drift; an overrun restarts the
+ * schedule instead of bursting to catch up.
+ */
+static int oled_grayscale_thread(void *parameters) {
+  ktime_t deadline = ktime_get();
+  ktime_t start;
+  unsigned int rate;
+  s64 slack_us;
+  u8 plane = 0;
+  int status_code;
+
+  /* Jitter in the subframe timing shows up as flicker. */
+  sched_set_fifo_low(current);
+  set_freezable();
+
+  while (!kthread_should_stop()) {
+    mutex_lock(&oled_graphics_lock);
+    mutex_lock(&grayscale_lock);
+
+    if (plane >= plane_count) {
+      plane = 0;
+    }
+
+    start = ktime_get();
+    ssd1306_batch_begin();
+    ssd1306_batch_command(SET_CONTRAST_CONTROL, 1, &plane_contrast[plane]);
+    ssd1306_batch_command(
+        SET_PAGE_ADDRESS, 2,
+        (uint8_t[]){OLED_PAGE_MIN, oled_graphics_params.panel_lines - 1});
+    ssd1306_batch_command(
+        SET_COLUMN_ADDRESS, 2,
+        (uint8_t[]){oled_graphics_params.panel_column_offset,
+                    oled_graphics_params.panel_column_offset +
+                        oled_graphics_params.panel_columns - 1});
+    ssd1306_batch_data(planes[plane], oled_frame_length());
+    status_code = ssd1306_batch_commit();
+    oled_grayscale_account(ktime_us_delta(ktime_get(), start));
+
+    mutex_unlock(&grayscale_lock);
+    mutex_unlock(&oled_graphics_lock);
+
+    plane += 1;
+
+    if (status_code < 0 && ssd1306_is_degraded()) {
+      /* Batches are dropped anyway until the next probe. */
+      msleep_interruptible(SSD1306_DEGRADED_PROBE_MS);
+      deadline = ktime_get();
+      continue;
+    }
+
+    rate = READ_ONCE(grayscale_rate);
+    if (0 == rate) {
+      /* Still sleep: a FIFO thread on a polled adapter would otherwise never
+       * let CFS tasks, or waiters on oled_graphics_lock, run. */
+      usleep_range(OLED_GRAYSCALE_SLACK_US, OLED_GRAYSCALE_SLACK_US * 2);
+      deadline = ktime_get();
+    } else {
+      deadline = ktime_add_ns(deadline, NSEC_PER_SEC / rate);
+      slack_us = ktime_us_delta(deadline, ktime_get());
+      if (slack_us > 0) {
+        usleep_range(slack_us, slack_us + OLED_GRAYSCALE_SLACK_US);
+      } else {
+        deadline = ktime_get();
+      }
+    }
+
+    try_to_freeze();
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Start cycling the bitplanes on the screen.
+ * @param None.
+ * @return 0 on success, -ENODATA if no image has been loaded, -ESTALE if the
+ * canvas has been rotated to or from portrait since, negative errno otherwise.
+ */
+int oled_grayscale_start(void) {
+  struct task_struct *thread;
+  int status_code;
+  bool stale;
+
+  if (handle_grayscale_thread) {
+    return 0;
+  }
+
+  if (0 == READ_ONCE(plane_count)) {
+    return -ENODATA;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  mutex_lock(&grayscale_lock);
+  stale = (plane_canvas_columns != oled_graphics_params.canvas_columns) ||
+          (plane_canvas_lines != oled_graphics_params.canvas_lines);
+  mutex_unlock(&grayscale_lock);
+  mutex_unlock(&oled_graphics_lock);
+
+  /* The bitplanes are laid out for the canvas at load time. */
+  if (stale) {
+    return -ESTALE;
+  }
+
+  mutex_lock(&grayscale_lock);
+  memset(&grayscale_stats, 0, sizeof(grayscale_stats));
+  flush_us_total = 0;
+  window_subframes = 0;
+  window_start = ktime_get();
+  mutex_unlock(&grayscale_lock);
+
+  oled_frame_set_hold(true);
+
+  /* The screen is written continuously, keep it runtime resumed. */
+  status_code = pm_runtime_resume_and_get(&i2c_client->dev);
+  if (status_code < 0) {
+    oled_frame_set_hold(false);
+    return status_code;
+  }
+
+  thread = kthread_run(oled_grayscale_thread, NULL, "oled_grayscale");
+  if (IS_ERR(thread)) {
+    pm_runtime_put_autosuspend(&i2c_client->dev);
+    oled_frame_set_hold(false);
+    return PTR_ERR(thread);
+  }
+  handle_grayscale_thread = thread;
+
+  return 0;
+}
+
+/**
+ * @brief Stop cycling the bitplanes and give the screen back to the frame
+ * scheduler.
+ * @param None.
+ * @return None.
+ */
+void oled_grayscale_stop(void) {
+  if (NULL == handle_grayscale_thread) {
+    return;
+  }
+
+  kthread_stop(handle_grayscale_thread);
+  handle_grayscale_thread = NULL;
+
+  pm_runtime_mark_last_busy(&i2c_client->dev);
+  pm_runtime_put_autosuspend(&i2c_client->dev);
+
+  /* Restores the default contrast and the shadow frame. */
+  oled_frame_set_hold(false);
+}
+
+/**
+ * @brief Select contrast weighted bitplanes instead of thermometer coded
+ * subframes.
+ * @param weighted true for contrast weighted bitplanes.
+ * @return None.
+ */
+void oled_grayscale_set_weighted(bool weighted) {
+  WRITE_ONCE(grayscale_weighted, weighted);
+}
+
+/**
+ * @brief Check whether contrast weighted bitplanes are selected.
+ * @param None.
+ * @return true if weighted.
+ */
+bool oled_grayscale_get_weighted(void) { return READ_ONCE(grayscale_weighted); }
+
+/**
+ * @brief Select the depth of the next image loaded.
+ * @param bits_per_pixel 2 or 4.
+ * @return 0 on success, -EINVAL on any other depth.
+ */
+int oled_grayscale_set_depth(unsigned int bits_per_pixel) {
+  if ((bits_per_pixel != 2) && (bits_per_pixel != 4)) {
+    return -EINVAL;
+  }
+
+  WRITE_ONCE(grayscale_depth, bits_per_pixel);
+  return 0;
+}
+
+/**
+ * @brief Get the depth of the next image loaded.
+ * @param None.
+ * @return Bits per pixel.
+ */
+unsigned int oled_grayscale_get_depth(void) {
+  return READ_ONCE(grayscale_depth);
+}
+
+/**
+ * @brief Set the target number of subframes written per second.
+ * @param rate Subframes per second, 0 for as fast as the transport allows.
+ * @return None.
+ */
+void oled_grayscale_set_rate(unsigned int rate) {
+  WRITE_ONCE(grayscale_rate, min_t(unsigned int, rate, OLED_GRAYSCALE_MAX_RATE));
+}
+
+/**
+ * @brief Get the target number of subframes written per second.
+ * @param None.
+ * @return Subframes per second.
+ */
+unsigned int oled_grayscale_get_rate(void) { return READ_ONCE(grayscale_rate); }
+
+/**
+ * @brief Get a snapshot of the achieved frame-rate modulation rate.
+ * @param p_stats Pointer to the struct to fill.
+ * @return None.
+ */
+void oled_grayscale_get_stats(oled_grayscale_stats_t *p_stats) {
+  mutex_lock(&grayscale_lock);
+  memcpy(p_stats, &grayscale_stats, sizeof(oled_grayscale_stats_t));
+  p_stats->planes = plane_count;
+  mutex_unlock(&grayscale_lock);
+
+  p_stats->transport = ssd1306_get_transport()->name;
+}
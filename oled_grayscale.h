@@ -0,0 +1,127 @@
+/**
+ * @file oled_grayscale.h
+ * @brief Temporal grayscale (frame-rate modulation) rendering header for the
+ * 1-bit SSD1306 OLED.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_GRAYSCALE_H
+#define OLED_GRAYSCALE_H
+
+#include "graphics.h"
+
+/* Source image sizes on the largest panel: row-major pixels, leftmost pixel
+ * in the most significant bits of each byte. Smaller panels take
+ * oled_frame_length() * 2 and * 4 bytes. */
+#define OLED_GRAYSCALE_2BPP_LENGTH (OLED_FRAME_LENGTH * 2)
+#define OLED_GRAYSCALE_4BPP_LENGTH (OLED_FRAME_LENGTH * 4)
+
+/* Bits per pixel of the source image, selected through grayscale_depth. */
+#define OLED_GRAYSCALE_DEFAULT_DEPTH 2
+
+/* Thermometer coding of 4bpp needs 15 subframes, one per level above 0. */
+#define OLED_GRAYSCALE_MAX_PLANES 15
+
+/* Target subframes per second. 0 is the benchmark setting, running as fast as
+ * the transport allows with only a short sleep between subframes. */
+#define OLED_GRAYSCALE_DEFAULT_RATE 180
+#define OLED_GRAYSCALE_MAX_RATE 1000
+
+/**
+ * @brief Struct reporting the achieved frame-rate modulation rate.
+ * @param transport Name of the transport the subframes are written through.
+ * @param subframes Number of subframes written since grayscale started.
+ * @param subframes_per_sec Subframes written per second over the last second.
+ * @param flush_us_avg Average time to write one subframe, in microseconds.
+ * @param flush_us_max Worst time to write one subframe, in microseconds.
+ * @param planes Number of bitplanes cycled per grayscale frame.
+ */
+typedef struct {
+  const char *transport;
+  u64 subframes;
+  u32 subframes_per_sec;
+  u32 flush_us_avg;
+  u32 flush_us_max;
+  u8 planes;
+} oled_grayscale_stats_t;
+
+/**
+ * @brief Convert a 2bpp or 4bpp source image into precomputed bitplanes.
+ * @param p_image Source image, row-major, 2 or 4 bytes per byte of the panel
+ * frame, see oled_frame_length.
+ * @param image_len Length of the source image, must match the selected depth.
+ * @return 0 on success, -EINVAL if image_len does not match the depth.
+ */
+int oled_grayscale_load(const u8 *p_image, size_t image_len);
+
+/**
+ * @brief Start cycling the bitplanes on the screen.
+ * @param None.
+ * @return 0 on success, -ENODATA if no image has been loaded, -ESTALE if the
+ * canvas has been rotated to or from portrait since, negative errno otherwise.
+ * @note The frame scheduler is held for as long as grayscale runs.
+ */
+int oled_grayscale_start(void);
+
+/**
+ * @brief Stop cycling the bitplanes and give the screen back to the frame
+ * scheduler.
+ * @param None.
+ * @return None.
+ */
+void oled_grayscale_stop(void);
+
+/**
+ * @brief Select contrast weighted bitplanes instead of thermometer coded
+ * subframes.
+ * @param weighted true to show one bitplane per bit of depth, each with a
+ * SET_CONTRAST_CONTROL weight matching its significance.
+ * @return None.
+ * @note Takes effect at the next oled_grayscale_load.
+ */
+void oled_grayscale_set_weighted(bool weighted);
+
+/**
+ * @brief Check whether contrast weighted bitplanes are selected.
+ * @param None.
+ * @return true if weighted.
+ */
+bool oled_grayscale_get_weighted(void);
+
+/**
+ * @brief Select the depth of the next image loaded.
+ * @param bits_per_pixel 2 or 4.
+ * @return 0 on success, -EINVAL on any other depth.
+ */
+int oled_grayscale_set_depth(unsigned int bits_per_pixel);
+
+/**
+ * @brief Get the depth of the next image loaded.
+ * @param None.
+ * @return Bits per pixel.
+ */
+unsigned int oled_grayscale_get_depth(void);
+
+/**
+ * @brief Set the target number of subframes written per second.
+ * @param rate Subframes per second, 0 for as fast as the transport allows.
+ * @return None.
+ */
+void oled_grayscale_set_rate(unsigned int rate);
+
+/**
+ * @brief Get the target number of subframes written per second.
+ * @param None.
+ * @return Subframes per second.
+ */
+unsigned int oled_grayscale_get_rate(void);
+
+/**
+ * @brief Get a snapshot of the achieved frame-rate modulation rate.
+ * @param p_stats Pointer to the struct to fill.
+ * @return None.
+ */
+void oled_grayscale_get_stats(oled_grayscale_stats_t *p_stats);
+
+#endif /* OLED_GRAYSCALE_H */
@@ -0,0 +1,10 @@
+/**
+ * @file oled_kunit_graphics.c
+ * @brief graphics.c compiled once more for oled_kunit.ko. Kbuild does not allow
+ * one object in two modules, so the suite links this wrapper instead of
+ * graphics.o.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "graphics.c"
@@ -0,0 +1,643 @@
+/**
+ * @file oled_kunit_test.c
+ * @brief KUnit suite of the render path: correctness of the byte streams
+ * emitted for the cursor, glyph, fill and bitmap paths, and microbenchmarks
+ * of rendering into the shadow buffer. Built as oled_kunit.ko with
+ * make OLED_KUNIT=y, which links its own copy of datalink.c and graphics.c
+ * and replaces the I2C transport with a capturing fake, so no panel is
+ * needed.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "graphics.h"
+
+#include <kunit/test.h>
+#include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/sched.h>
+
+/* Capacity of the capture of one test. */
+#define OLED_KUNIT_MAX_MSGS 256
+#define OLED_KUNIT_LOG_LENGTH 8192
+
+/* Iterations of the microbenchmarks. */
+#define OLED_KUNIT_BENCH_LINES 5000
+#define OLED_KUNIT_BENCH_FRAMES 500
+
+/* Characters of one line of 6x8 glyphs on a 128 pixels wide canvas. */
+#define OLED_KUNIT_LINE_CHARS (OLED_CANVAS_WIDTH_PIXELS / OLED_FONT_CHAR_WIDTH)
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Luyao Han");
+MODULE_DESCRIPTION("KUnit suite of the ssd1306 oled render path");
+
+/**
+ * @brief Link the symbol to its spawn in graphics.c
+ */
+extern oled_graphics_params_t oled_graphics_params;
+
+/**
+ * @brief Stands in for the probed i2c_client, only its address is used to
+ * build messages.
+ */
+static struct i2c_client oled_kunit_client = {.addr = 0x3c};
+
+/**
+ * @brief Pointer to the i2c_client instance, driver.c is not linked in.
+ */
+struct i2c_client *i2c_client = &oled_kunit_client;
+
+/**
+ * @brief Struct capturing the messages submitted through the fake transport.
+ * @param log Bytes of all messages, control bytes included, back to back.
+ * @param log_length Bytes used in log.
+ * @param msg_offset Offset of each message in log.
+ * @param msg_length Length of each message.
+ * @param msg_count Number of messages captured.
+ * @param overflow Set if a message did not fit into the capture.
+ */
+typedef struct {
+  u8 log[OLED_KUNIT_LOG_LENGTH];
+  size_t log_length;
+  size_t msg_offset[OLED_KUNIT_MAX_MSGS];
+  size_t msg_length[OLED_KUNIT_MAX_MSGS];
+  unsigned int msg_count;
+  bool overflow;
+} oled_kunit_capture_t;
+
+static oled_kunit_capture_t capture;
+
+/**
+ * @brief Struct modelling the controller in horizontal addressing mode, fed
+ * with every message that reaches the fake bus.
+ * @param gddram Display RAM.
+ * @param first_page First page of the address window.
+ * @param last_page Last page of the address window, inclusive.
+ * @param first_column First column of the address window.
+ * @param last_column Last column of the address window, inclusive.
+ * @param page Page of the address pointer.
+ * @param column Column of the address pointer.
+ */
+typedef struct {
+  u8 gddram[OLED_PAGE_LENGTH][OLED_COLUMN_LENGTH];
+  u8 first_page;
+  u8 last_page;
+  u8 first_column;
+  u8 last_column;
+  u8 page;
+  u8 column;
+} oled_kunit_controller_t;
+
+static oled_kunit_controller_t controller;
+
+/**
+ * @brief Transfers submitted since the last reset, and the one that fails
+ * after its messages landed, 0 for none.
+ */
+static unsigned int transfer_count;
+static unsigned int fail_transfer;
+
+/**
+ * @brief Largest number of messages submitted in one transfer since the last
+ * reset.
+ */
+static int max_transfer_msgs;
+
+/**
+ * @brief Bytes submitted through the null transport of the benchmarks.
+ */
+static u64 null_bytes;
+
+/**
+ * @brief Apply one message to the controller model.
+ * @param p_msg Message that reached the controller.
+ * @return None.
+ */
+static void oled_kunit_controller_apply(const struct i2c_msg *p_msg) {
+  const u8 *p_buf = p_msg->buf;
+  int index;
+
+  if ((p_buf[0] == CONTROL_BYTE_COMMAND_STREAM) && (p_msg->len == 4)) {
+    if (p_buf[1] == SET_PAGE_ADDRESS) {
+      controller.first_page = p_buf[2];
+      controller.last_page = p_buf[3];
+      controller.page = p_buf[2];
+    } else if (p_buf[1] == SET_COLUMN_ADDRESS) {
+      controller.first_column = p_buf[2];
+      controller.last_column = p_buf[3];
+      controller.column = p_buf[2];
+    }
+    return;
+  }
+
+  if (p_buf[0] != CONTROL_BYTE_DATA_STREAM) {
+    return;
+  }
+
+  for (index = 1; index < p_msg->len; ++index) {
+    controller.gddram[controller.page % OLED_PAGE_LENGTH][controller.column] =
+        p_buf[index];
+    if (controller.column < controller.last_column) {
+      controller.column += 1;
+      continue;
+    }
+    controller.column = controller.first_column;
+    controller.page = (controller.page < controller.last_page)
+                          ? controller.page + 1
+                          : controller.first_page;
+  }
+}
+
+/**
+ * @brief Transfer of the fake transport: record every message.
+ * @param msgs Messages to transfer.
+ * @param num Number of messages.
+ * @return num, or -EIO for the transfer selected by fail_transfer. Its
+ * messages still land, like a transfer losing only the final ACK.
+ */
+static int oled_kunit_capture_transfer(struct i2c_msg *msgs, int num) {
+  int index;
+
+  transfer_count += 1;
+  max_transfer_msgs = max(max_transfer_msgs, num);
+
+  for (index = 0; index < num; ++index) {
+    oled_kunit_controller_apply(&msgs[index]);
+
+    if ((capture.msg_count == OLED_KUNIT_MAX_MSGS) ||
+        (capture.log_length + msgs[index].len > OLED_KUNIT_LOG_LENGTH)) {
+      capture.overflow = true;
+      continue;
+    }
+    capture.msg_offset[capture.msg_count] = capture.log_length;
+    capture.msg_length[capture.msg_count] = msgs[index].len;
+    memcpy(&capture.log[capture.log_length], msgs[index].buf,
+           msgs[index].len);
+    capture.log_length += msgs[index].len;
+    capture.msg_count += 1;
+  }
+
+  return (transfer_count == fail_transfer) ? -EIO : num;
+}
+
+/**
+ * @brief Transfer of the benchmark transport: count the bytes only.
+ * @param msgs Messages to transfer.
+ * @param num Number of messages.
+ * @return num.
+ */
+static int oled_kunit_null_transfer(struct i2c_msg *msgs, int num) {
+  int index;
+
+  for (index = 0; index < num; ++index) {
+    null_bytes += msgs[index].len;
+  }
+
+  return num;
+}
+
+static const ssd1306_transport_t oled_kunit_capture_transport = {
+    .name = "kunit-capture", .transfer = oled_kunit_capture_transfer};
+
+static const ssd1306_transport_t oled_kunit_null_transport = {
+    .name = "kunit-null", .transfer = oled_kunit_null_transfer};
+
+/**
+ * @brief Forget everything captured so far.
+ * @param None.
+ * @return None.
+ */
+static void oled_kunit_reset(void) {
+  capture.log_length = 0;
+  capture.msg_count = 0;
+  capture.overflow = false;
+  transfer_count = 0;
+  fail_transfer = 0;
+  max_transfer_msgs = 0;
+}
+
+/**
+ * @brief Expect one captured message to be exactly the given bytes.
+ * @param test The running test.
+ * @param index Index of the message.
+ * @param p_expected Expected bytes, control byte included.
+ * @param length Length of p_expected.
+ * @return None.
+ */
+static void oled_kunit_expect_msg(struct kunit *test, unsigned int index,
+                                  const u8 *p_expected, size_t length) {
+  KUNIT_ASSERT_LT(test, index, capture.msg_count);
+  KUNIT_EXPECT_EQ(test, capture.msg_length[index], length);
+  if (capture.msg_length[index] == length) {
+    KUNIT_EXPECT_EQ(test,
+                    memcmp(&capture.log[capture.msg_offset[index]],
+                           p_expected, length),
+                    0);
+  }
+}
+
+/**
+ * @brief Expect the two messages setting an address window.
+ * @param test The running test.
+ * @param index Index of the SET_PAGE_ADDRESS message.
+ * @param first_line First line (page) of the window.
+ * @param last_line Last line (page) of the window, inclusive.
+ * @param first_position First controller column of the window.
+ * @param last_position Last controller column of the window, inclusive.
+ * @return None.
+ */
+static void oled_kunit_expect_window(struct kunit *test, unsigned int index,
+                                     u8 first_line, u8 last_line,
+                                     u8 first_position, u8 last_position) {
+  oled_kunit_expect_msg(
+      test, index,
+      (u8[]){CONTROL_BYTE_COMMAND_STREAM, SET_PAGE_ADDRESS, first_line,
+             last_line},
+      4);
+  oled_kunit_expect_msg(
+      test, index + 1,
+      (u8[]){CONTROL_BYTE_COMMAND_STREAM, SET_COLUMN_ADDRESS, first_position,
+             last_position},
+      4);
+}
+
+/**
+ * @brief Gather the display data of consecutive data messages.
+ * @param test The running test.
+ * @param index Index of the first data message.
+ * @param p_data Buffer receiving the data bytes, control bytes stripped.
+ * @param max_length Size of p_data.
+ * @return Number of data bytes gathered.
+ */
+static size_t oled_kunit_gather_data(struct kunit *test, unsigned int index,
+                                     u8 *p_data, size_t max_length) {
+  size_t length = 0;
+  size_t chunk;
+  const u8 *p_msg;
+
+  for (; index < capture.msg_count; ++index) {
+    p_msg = &capture.log[capture.msg_offset[index]];
+    if (p_msg[0] != CONTROL_BYTE_DATA_STREAM) {
+      break;
+    }
+    chunk = capture.msg_length[index] - 1;
+    KUNIT_ASSERT_LE(test, length + chunk, max_length);
+    memcpy(&p_data[length], &p_msg[1], chunk);
+    length += chunk;
+  }
+
+  return length;
+}
+
+/**
+ * @brief Per test setup: capture an empty 128x64 landscape canvas.
+ * @param test The test about to run.
+ * @return 0.
+ */
+static int oled_kunit_init(struct kunit *test) {
+  memset(&controller, 0, sizeof(controller));
+  oled_kunit_reset();
+
+  ssd1306_set_transport(&oled_kunit_capture_transport);
+  ssd1306_set_bus_max_chunk(SSD1306_BUS_MAX_CHUNK);
+
+  oled_set_rotation(OLED_ROTATION_0);
+  oled_set_geometry(128, 64);
+  oled_flush_dirty();
+
+  oled_kunit_reset();
+  return 0;
+}
+
+/**
+ * @brief Per test teardown: restore the I2C transport.
+ * @param test The test that ran.
+ * @return None.
+ */
+static void oled_kunit_exit(struct kunit *test) {
+  ssd1306_set_transport(NULL);
+  ssd1306_apply_adapter_quirks(NULL);
+}
+
+/**
+ * @brief The cursor accepts every position of the canvas, up to the last
+ * column, and nothing outside of it.
+ */
+static void oled_kunit_cursor_bounds_test(struct kunit *test) {
+  oled_cursor_coordinate_t *p_cursor = &oled_graphics_params.cursor_coordinate;
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 7, .position = 127});
+  KUNIT_EXPECT_EQ(test, p_cursor->line, (u8)7);
+  KUNIT_EXPECT_EQ(test, p_cursor->position, (u8)127);
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 8, .position = 0});
+  KUNIT_EXPECT_EQ(test, p_cursor->line, (u8)7);
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 0, .position = 128});
+  KUNIT_EXPECT_EQ(test, p_cursor->position, (u8)127);
+}
+
+/**
+ * @brief A glyph printed at the cursor goes out as one address window around
+ * the slices that changed, followed by those slices.
+ */
+static void oled_kunit_cursor_glyph_test(struct kunit *test) {
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 3, .position = 60});
+  oled_putc('A');
+
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  KUNIT_EXPECT_EQ(test, capture.msg_count, 3u);
+
+  /* The blank last slice of 'A' matches the canvas and is not sent. */
+  oled_kunit_expect_window(test, 0, 3, 3, 60, 64);
+  oled_kunit_expect_msg(test, 2,
+                        (u8[]){CONTROL_BYTE_DATA_STREAM, 0x7C, 0x12, 0x11,
+                               0x12, 0x7C},
+                        6);
+  KUNIT_EXPECT_EQ(test, oled_graphics_params.cursor_coordinate.position,
+                  (u8)(60 + OLED_FONT_CHAR_WIDTH));
+}
+
+/**
+ * @brief Reprinting the same glyph sends nothing, characters outside of the
+ * font are drawn as blanks.
+ */
+static void oled_kunit_glyph_test(struct kunit *test) {
+  oled_putc('B');
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  oled_kunit_reset();
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 0, .position = 0});
+  oled_putc('B');
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 0);
+  KUNIT_EXPECT_EQ(test, capture.msg_count, 0u);
+
+  oled_fill_all(0xFF);
+  oled_flush_dirty();
+  oled_kunit_reset();
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = 1, .position = 0});
+  oled_putc(0xC8);
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  oled_kunit_expect_window(test, 0, 1, 1, 0, 5);
+  oled_kunit_expect_msg(
+      test, 2, (u8[]){CONTROL_BYTE_DATA_STREAM, 0, 0, 0, 0, 0, 0}, 7);
+}
+
+/**
+ * @brief A full fill goes out as one full-screen window, a window fill as one
+ * window shared by its lines.
+ */
+static void oled_kunit_fill_test(struct kunit *test) {
+  static u8 data[OLED_FRAME_LENGTH];
+  size_t length, index;
+
+  oled_fill_all(0xAA);
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  oled_kunit_expect_window(test, 0, 0, 7, 0, 127);
+  length = oled_kunit_gather_data(test, 2, data, sizeof(data));
+  KUNIT_EXPECT_EQ(test, length, (size_t)OLED_FRAME_LENGTH);
+  for (index = 0; index < length; ++index) {
+    KUNIT_ASSERT_EQ(test, data[index], (u8)0xAA);
+  }
+
+  /* Nothing changed since. */
+  oled_kunit_reset();
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 0);
+  KUNIT_EXPECT_EQ(test, capture.msg_count, 0u);
+
+  oled_fill_window(2, 3, 10, 17, 0x0F);
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  oled_kunit_expect_window(test, 0, 2, 3, 10, 17);
+  length = oled_kunit_gather_data(test, 2, data, sizeof(data));
+  KUNIT_EXPECT_EQ(test, length, (size_t)16);
+  for (index = 0; index < length; ++index) {
+    KUNIT_ASSERT_EQ(test, data[index], (u8)0x0F);
+  }
+  KUNIT_EXPECT_FALSE(test, capture.overflow);
+}
+
+/**
+ * @brief A bitmap crossing the bottom right corner is clipped to the canvas.
+ */
+static void oled_kunit_bitmap_test(struct kunit *test) {
+  u8 bitmap[4][8];
+  u8 data[8];
+  size_t row, column;
+
+  for (row = 0; row < 4; ++row) {
+    for (column = 0; column < 8; ++column) {
+      bitmap[row][column] = row * 8 + column + 1;
+    }
+  }
+
+  oled_draw_bitmap(6, 124, 4, 8, &bitmap[0][0]);
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  oled_kunit_expect_window(test, 0, 6, 7, 124, 127);
+  KUNIT_ASSERT_EQ(test, oled_kunit_gather_data(test, 2, data, sizeof(data)),
+                  sizeof(data));
+  KUNIT_EXPECT_EQ(test, memcmp(&data[0], &bitmap[0][0], 4), 0);
+  KUNIT_EXPECT_EQ(test, memcmp(&data[4], &bitmap[1][0], 4), 0);
+}
+
+/**
+ * @brief Smaller panels only transfer their own frame, 64x48 panels at the
+ * columns they are wired to.
+ */
+static void oled_kunit_geometry_test(struct kunit *test) {
+  static u8 data[OLED_FRAME_LENGTH];
+
+  KUNIT_EXPECT_EQ(test, oled_set_geometry(96, 16), -EINVAL);
+
+  KUNIT_ASSERT_EQ(test, oled_set_geometry(128, 32), 0);
+  oled_fill_all(0xFF);
+  oled_flush_dirty();
+  oled_kunit_expect_window(test, 0, 0, 3, 0, 127);
+  KUNIT_EXPECT_EQ(test, oled_kunit_gather_data(test, 2, data, sizeof(data)),
+                  (size_t)512);
+
+  oled_kunit_reset();
+  KUNIT_ASSERT_EQ(test, oled_set_geometry(64, 48), 0);
+  oled_fill_all(0xFF);
+  oled_flush_dirty();
+  oled_kunit_expect_window(test, 0, 0, 5, 32, 95);
+  KUNIT_EXPECT_EQ(test, oled_kunit_gather_data(test, 2, data, sizeof(data)),
+                  (size_t)384);
+}
+
+/**
+ * @brief A frame spanning several batches reaches the controller intact
+ * although a transfer of the second batch fails: that batch starts by setting
+ * the address window again, which the retry replays from.
+ */
+static void oled_kunit_batch_retry_test(struct kunit *test) {
+  static u8 frame[OLED_FRAME_LENGTH];
+  size_t index;
+
+  for (index = 0; index < sizeof(frame); ++index) {
+    frame[index] = index % 251 + 1;
+  }
+  oled_draw_bitmap(0, 0, OLED_PAGE_LENGTH, OLED_COLUMN_LENGTH, frame);
+
+  /* 16 byte transfers need more messages than one batch holds. */
+  ssd1306_set_bus_max_chunk(SSD1306_BUS_MIN_CHUNK);
+  fail_transfer = SSD1306_BATCH_MAX_MSGS + 6;
+
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  KUNIT_EXPECT_GT(test, transfer_count, fail_transfer);
+  KUNIT_EXPECT_EQ(test,
+                  memcmp(controller.gddram, oled_shadow_buffer,
+                         OLED_FRAME_LENGTH),
+                  0);
+}
+
+/**
+ * @brief Transfers stay within the message count and message length limits
+ * of the adapter, and the frame still reaches the controller intact.
+ */
+static void oled_kunit_adapter_quirks_test(struct kunit *test) {
+  static const struct i2c_adapter_quirks quirks = {.max_num_msgs = 2,
+                                                   .max_write_len = 24};
+  static u8 frame[OLED_FRAME_LENGTH];
+  unsigned int index;
+
+  for (index = 0; index < sizeof(frame); ++index) {
+    frame[index] = index % 251 + 1;
+  }
+  oled_draw_bitmap(0, 0, OLED_PAGE_LENGTH, OLED_COLUMN_LENGTH, frame);
+
+  ssd1306_apply_adapter_quirks(&quirks);
+  KUNIT_EXPECT_EQ(test, ssd1306_get_bus_max_chunk(), 24u);
+
+  KUNIT_EXPECT_EQ(test, oled_flush_dirty(), 1);
+  KUNIT_EXPECT_LE(test, max_transfer_msgs, 2);
+  for (index = 0; index < capture.msg_count; ++index) {
+    KUNIT_ASSERT_LE(test, capture.msg_length[index], (size_t)24);
+  }
+  KUNIT_EXPECT_EQ(test,
+                  memcmp(controller.gddram, oled_shadow_buffer,
+                         OLED_FRAME_LENGTH),
+                  0);
+}
+
+/**
+ * @brief Convert a count over a duration into a rate per second.
+ * @param count Number of operations.
+ * @param duration_ns Duration of the operations in nanoseconds.
+ * @return Operations per second.
+ */
+static u64 oled_kunit_rate(u64 count, u64 duration_ns) {
+  return div64_u64(count * NSEC_PER_SEC, max_t(u64, duration_ns, 1));
+}
+
+/**
+ * @brief Print one line of text at the start of a line of the canvas.
+ * @param line The line (page) to print to.
+ * @param p_text OLED_KUNIT_LINE_CHARS characters.
+ * @return None.
+ */
+static void oled_kunit_print_line(uint8_t line, const char *p_text) {
+  int index;
+
+  oled_set_cursor((oled_cursor_coordinate_t){.line = line, .position = 0});
+  for (index = 0; index < OLED_KUNIT_LINE_CHARS; ++index) {
+    oled_putc(p_text[index]);
+  }
+}
+
+/**
+ * @brief Glyphs rasterized into the shadow buffer per second, with every
+ * glyph changing and with the text-cell cache hitting.
+ */
+static void oled_kunit_bench_glyphs(struct kunit *test) {
+  static const char *const texts[] = {"ABCDEFGHIJKLMNOPQRSTU",
+                                      "abcdefghijklmnopqrstu"};
+  const u64 glyphs = (u64)OLED_KUNIT_BENCH_LINES * OLED_KUNIT_LINE_CHARS;
+  u64 start, changed_ns, cached_ns;
+  int pass;
+
+  ssd1306_set_transport(&oled_kunit_null_transport);
+
+  start = ktime_get_ns();
+  for (pass = 0; pass < OLED_KUNIT_BENCH_LINES; ++pass) {
+    /* Each line alternates text on every visit, so no glyph is cached. */
+    oled_kunit_print_line(pass % OLED_PAGE_LENGTH,
+                          texts[(pass / OLED_PAGE_LENGTH) & 1]);
+  }
+  changed_ns = ktime_get_ns() - start;
+
+  start = ktime_get_ns();
+  for (pass = 0; pass < OLED_KUNIT_BENCH_LINES; ++pass) {
+    oled_kunit_print_line(0, texts[0]);
+  }
+  cached_ns = ktime_get_ns() - start;
+
+  kunit_info(test, "glyphs/sec: %llu changed, %llu cached\n",
+             oled_kunit_rate(glyphs, changed_ns),
+             oled_kunit_rate(glyphs, cached_ns));
+}
+
+/**
+ * @brief Full text frames rendered into the shadow buffer per second, and
+ * rendered and flushed through a transport that drops the bytes.
+ */
+static void oled_kunit_bench_frames(struct kunit *test) {
+  static const char *const texts[] = {"0123456789 0123456789",
+                                      "9876543210 9876543210"};
+  u64 start, render_ns, flush_ns;
+  uint8_t line;
+  int frame;
+
+  ssd1306_set_transport(&oled_kunit_null_transport);
+
+  start = ktime_get_ns();
+  for (frame = 0; frame < OLED_KUNIT_BENCH_FRAMES; ++frame) {
+    for (line = 0; line < OLED_PAGE_LENGTH; ++line) {
+      oled_kunit_print_line(line, texts[frame & 1]);
+    }
+    cond_resched();
+  }
+  render_ns = ktime_get_ns() - start;
+  oled_flush_dirty();
+
+  null_bytes = 0;
+  start = ktime_get_ns();
+  for (frame = 0; frame < OLED_KUNIT_BENCH_FRAMES; ++frame) {
+    for (line = 0; line < OLED_PAGE_LENGTH; ++line) {
+      oled_kunit_print_line(line, texts[frame & 1]);
+    }
+    oled_flush_dirty();
+    cond_resched();
+  }
+  flush_ns = ktime_get_ns() - start;
+
+  kunit_info(test,
+             "frames/sec: %llu rendered, %llu rendered and flushed "
+             "(%llu bytes/frame)\n",
+             oled_kunit_rate(OLED_KUNIT_BENCH_FRAMES, render_ns),
+             oled_kunit_rate(OLED_KUNIT_BENCH_FRAMES, flush_ns),
+             div64_u64(null_bytes, OLED_KUNIT_BENCH_FRAMES));
+}
+
+static struct kunit_case oled_kunit_cases[] = {
+    KUNIT_CASE(oled_kunit_cursor_bounds_test),
+    KUNIT_CASE(oled_kunit_cursor_glyph_test),
+    KUNIT_CASE(oled_kunit_glyph_test),
+    KUNIT_CASE(oled_kunit_fill_test),
+    KUNIT_CASE(oled_kunit_bitmap_test),
+    KUNIT_CASE(oled_kunit_geometry_test),
+    KUNIT_CASE(oled_kunit_batch_retry_test),
+    KUNIT_CASE(oled_kunit_adapter_quirks_test),
+    KUNIT_CASE(oled_kunit_bench_glyphs),
+    KUNIT_CASE(oled_kunit_bench_frames),
+    {}};
+
+static struct kunit_suite oled_kunit_suite = {
+    .name = "oled_render",
+    .init = oled_kunit_init,
+    .exit = oled_kunit_exit,
+    .test_cases = oled_kunit_cases};
+
+kunit_test_suites(&oled_kunit_suite);
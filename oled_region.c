@@ -0,0 +1,422 @@
+/**
+ * @file oled_region.c
+ * @brief Independent text / bitmap regions (windows) of the oled screen. Each
+ * region is re-rendered on its own when its content changes, and since only
+ * the bytes that change are marked dirty, the following flush only transfers
+ * that part of the region's window.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_region.h"
+#include "oled_frame.h"
+
+#include <linux/mutex.h>
+#include <linux/string.h>
+
+/**
+ * @brief Book-keeping of one region.
+ * @param used true while the slot holds a region.
+ * @param attrs Name, geometry and style of the region.
+ * @param show_bitmap true when the region shows bitmap rather than text.
+ * @param text Text of the region, rows separated by newlines.
+ * @param bitmap Page-major bitmap of the region, lines * columns bytes.
+ */
+typedef struct {
+  bool used;
+  oled_region_attrs_t attrs;
+  bool show_bitmap;
+  char text[OLED_REGION_TEXT_LENGTH];
+  uint8_t bitmap[OLED_FRAME_LENGTH];
+} oled_region_t;
+
+/**
+ * @brief All region slots, protected by oled_graphics_lock.
+ */
+static oled_region_t regions[OLED_REGION_MAX];
+
+/**
+ * @brief Link the symbol to its spawn in graphics.c
+ */
+extern oled_graphics_params_t oled_graphics_params;
+
+/**
+ * @brief Get a region by index.
+ * @param index Index of the region.
+ * @return The region, NULL if the slot is out of range or unused.
+ * @note Caller must hold oled_graphics_lock.
+ */
+static oled_region_t *oled_region_get(int index) {
+  if ((index < 0) || (index >= OLED_REGION_MAX) || !regions[index].used) {
+    return NULL;
+  }
+  return &regions[index];
+}
+
+/**
+ * @brief Render a region into the shadow buffer.
+ * @param p_region The region.
+ * @return None.
+ * @note Every row of the window is redrawn, but only the bytes that differ
+ * from the shadow buffer end up in the next flush. Caller must hold
+ * oled_graphics_lock.
+ */
+static void oled_region_render(const oled_region_t *p_region) {
+  const oled_region_attrs_t *p_attrs = &p_region->attrs;
+  const uint8_t last_line = p_attrs->line + p_attrs->lines - 1;
+  const uint8_t last_position = p_attrs->position + p_attrs->columns - 1;
+  const char *p_row = p_region->text;
+  const char *p_row_end;
+  uint8_t line = p_attrs->line;
+
+  if (p_region->show_bitmap) {
+    oled_draw_bitmap(p_attrs->line, p_attrs->position, p_attrs->lines,
+                     p_attrs->columns, p_region->bitmap);
+    return;
+  }
+
+  /* Rows past the end of the text are drawn empty, clearing the window. */
+  while (line + p_attrs->font_scale - 1 <= last_line) {
+    p_row_end = strchrnul(p_row, '\n');
+    oled_draw_text_span(line, p_attrs->position, last_position, p_row,
+                        p_row_end - p_row, p_attrs->align,
+                        p_attrs->font_scale, p_attrs->invert);
+    line += p_attrs->font_scale;
+    p_row = (*p_row_end == '\n') ? p_row_end + 1 : p_row_end;
+  }
+
+  /* Lines left over below the last full row of scaled glyphs. */
+  if (line <= last_line) {
+    oled_fill_window(line, last_line, p_attrs->position, last_position,
+                     p_attrs->invert ? 0xFF : 0x00);
+  }
+}
+
+/**
+ * @brief Create a region. The window starts out cleared.
+ * @param p_attrs Name and geometry of the region, the remaining attributes
+ * are set to their defaults.
+ * @return Index of the region on success, -EINVAL if the name is empty or the
+ * window does not fit the canvas, -EEXIST if the name is taken, -ENOSPC if
+ * OLED_REGION_MAX regions exist.
+ */
+int oled_region_create(const oled_region_attrs_t *p_attrs) {
+  oled_region_t *p_region;
+  int index;
+  int status_code = -ENOSPC;
+
+  if ((p_attrs->name[0] == '\0') || strchr(p_attrs->name, '/') ||
+      (strnlen(p_attrs->name, OLED_REGION_NAME_LENGTH) ==
+       OLED_REGION_NAME_LENGTH) ||
+      (p_attrs->lines == 0) || (p_attrs->columns == 0)) {
+    return -EINVAL;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+
+  if ((p_attrs->line + p_attrs->lines > oled_graphics_params.canvas_lines) ||
+      (p_attrs->position + p_attrs->columns >
+       oled_graphics_params.canvas_columns)) {
+    status_code = -EINVAL;
+    goto RETURN;
+  }
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (regions[index].used &&
+        (strcmp(regions[index].attrs.name, p_attrs->name) == 0)) {
+      status_code = -EEXIST;
+      goto RETURN;
+    }
+  }
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (!regions[index].used) {
+      break;
+    }
+  }
+  if (index == OLED_REGION_MAX) {
+    goto RETURN;
+  }
+
+  p_region = &regions[index];
+  memset(p_region, 0, sizeof(oled_region_t));
+  p_region->used = true;
+  strscpy(p_region->attrs.name, p_attrs->name, OLED_REGION_NAME_LENGTH);
+  p_region->attrs.line = p_attrs->line;
+  p_region->attrs.position = p_attrs->position;
+  p_region->attrs.lines = p_attrs->lines;
+  p_region->attrs.columns = p_attrs->columns;
+  p_region->attrs.align = OLED_ALIGN_LEFT;
+  p_region->attrs.font_scale = 1;
+  p_region->attrs.invert = false;
+
+  oled_region_render(p_region);
+  status_code = index;
+
+RETURN:
+  mutex_unlock(&oled_graphics_lock);
+
+  if (status_code >= 0) {
+    oled_frame_request_flush();
+  }
+  return status_code;
+}
+
+/**
+ * @brief Remove a region and clear its window.
+ * @param index Index of the region.
+ * @return None.
+ */
+void oled_region_remove(int index) {
+  oled_region_t *p_region;
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    oled_fill_window(p_region->attrs.line,
+                     p_region->attrs.line + p_region->attrs.lines - 1,
+                     p_region->attrs.position,
+                     p_region->attrs.position + p_region->attrs.columns - 1,
+                     0x00);
+    p_region->used = false;
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_frame_request_flush();
+}
+
+/**
+ * @brief Look up a region by name.
+ * @param name Name of the region, a trailing newline is ignored.
+ * @return Index of the region, -ENOENT if there is none with that name.
+ */
+int oled_region_find(const char *name) {
+  size_t name_len = strcspn(name, "\n");
+  int index;
+  int status_code = -ENOENT;
+
+  mutex_lock(&oled_graphics_lock);
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (regions[index].used &&
+        (strlen(regions[index].attrs.name) == name_len) &&
+        (strncmp(regions[index].attrs.name, name, name_len) == 0)) {
+      status_code = index;
+      break;
+    }
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  return status_code;
+}
+
+/**
+ * @brief Get the attributes of a region.
+ * @param index Index of the region.
+ * @param p_attrs Filled with the attributes.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_get_attrs(int index, oled_region_attrs_t *p_attrs) {
+  oled_region_t *p_region;
+  int status_code = -ENOENT;
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    memcpy(p_attrs, &p_region->attrs, sizeof(oled_region_attrs_t));
+    status_code = 0;
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  return status_code;
+}
+
+/**
+ * @brief Change the alignment, font and inversion of a region and redraw it.
+ * @param index Index of the region.
+ * @param p_attrs New attributes, name and geometry are ignored.
+ * @return 0 on success, -EINVAL on an unsupported font_scale, -ENOENT if the
+ * region does not exist.
+ */
+int oled_region_set_style(int index, const oled_region_attrs_t *p_attrs) {
+  oled_region_t *p_region;
+  int status_code = -ENOENT;
+
+  if ((p_attrs->font_scale < 1) ||
+      (p_attrs->font_scale > OLED_FONT_SCALE_MAX)) {
+    return -EINVAL;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    p_region->attrs.align = p_attrs->align;
+    p_region->attrs.font_scale = p_attrs->font_scale;
+    p_region->attrs.invert = p_attrs->invert;
+    oled_region_render(p_region);
+    status_code = 0;
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  if (status_code == 0) {
+    oled_frame_request_flush();
+  }
+  return status_code;
+}
+
+/**
+ * @brief Set the text of a region and redraw it.
+ * @param index Index of the region.
+ * @param p_text Text, rows separated by newlines. A single trailing newline is
+ * dropped.
+ * @param text_len Length of p_text, truncated to OLED_REGION_TEXT_LENGTH - 1.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_set_text(int index, const char *p_text, size_t text_len) {
+  oled_region_t *p_region;
+  int status_code = -ENOENT;
+
+  if ((text_len > 0) && (p_text[text_len - 1] == '\n')) {
+    text_len -= 1;
+  }
+  text_len = min_t(size_t, text_len, OLED_REGION_TEXT_LENGTH - 1);
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    memcpy(p_region->text, p_text, text_len);
+    p_region->text[text_len] = '\0';
+    p_region->show_bitmap = false;
+    oled_region_render(p_region);
+    status_code = 0;
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  if (status_code == 0) {
+    oled_frame_request_flush();
+  }
+  return status_code;
+}
+
+/**
+ * @brief Get the text of a region.
+ * @param index Index of the region.
+ * @param p_text Filled with the NUL terminated text, OLED_REGION_TEXT_LENGTH
+ * bytes.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_get_text(int index, char *p_text) {
+  oled_region_t *p_region;
+  int status_code = -ENOENT;
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    memcpy(p_text, p_region->text, OLED_REGION_TEXT_LENGTH);
+    status_code = 0;
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  return status_code;
+}
+
+/**
+ * @brief Show a bitmap in a region instead of text.
+ * @param index Index of the region.
+ * @param p_bitmap Page-major bitmap covering the whole window.
+ * @param bitmap_len Must equal lines * columns of the region.
+ * @return 0 on success, -EINVAL on a length mismatch, -ENOENT if the region
+ * does not exist.
+ */
+int oled_region_set_bitmap(int index, const uint8_t *p_bitmap,
+                           size_t bitmap_len) {
+  oled_region_t *p_region;
+  int status_code = -ENOENT;
+
+  mutex_lock(&oled_graphics_lock);
+
+  p_region = oled_region_get(index);
+  if (p_region) {
+    if (bitmap_len != p_region->attrs.lines * p_region->attrs.columns) {
+      status_code = -EINVAL;
+      goto RETURN;
+    }
+    memcpy(p_region->bitmap, p_bitmap, bitmap_len);
+    p_region->show_bitmap = true;
+    oled_region_render(p_region);
+    status_code = 0;
+  }
+
+RETURN:
+  mutex_unlock(&oled_graphics_lock);
+
+  if (status_code == 0) {
+    oled_frame_request_flush();
+  }
+  return status_code;
+}
+
+/**
+ * @brief Redraw the regions overlapping a window of the canvas, after another
+ * renderer drew into it.
+ * @param first_line First line (page) drawn.
+ * @param last_line Last line (page) drawn, inclusive.
+ * @param first_position First position (column) drawn.
+ * @param last_position Last position (column) drawn, inclusive.
+ * @return None.
+ * @note Caller must hold oled_graphics_lock. Only bytes that differ from the
+ * shadow buffer are marked dirty, so an untouched region costs no transfer.
+ */
+void oled_region_redraw_overlapping(uint8_t first_line, uint8_t last_line,
+                                    uint8_t first_position,
+                                    uint8_t last_position) {
+  const oled_region_attrs_t *p_attrs;
+  int index;
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (!regions[index].used) {
+      continue;
+    }
+    p_attrs = &regions[index].attrs;
+    if ((p_attrs->line > last_line) ||
+        (p_attrs->line + p_attrs->lines - 1 < first_line) ||
+        (p_attrs->position > last_position) ||
+        (p_attrs->position + p_attrs->columns - 1 < first_position)) {
+      continue;
+    }
+    oled_region_render(&regions[index]);
+  }
+}
+
+/**
+ * @brief Redraw all regions into the shadow buffer, e.g. after the canvas has
+ * been cleared.
+ * @param None.
+ * @return None.
+ */
+void oled_region_redraw_all(void) {
+  int index;
+
+  mutex_lock(&oled_graphics_lock);
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (regions[index].used) {
+      oled_region_render(&regions[index]);
+    }
+  }
+
+  mutex_unlock(&oled_graphics_lock);
+
+  oled_frame_request_flush();
+}
@@ -0,0 +1,139 @@
+/**
+ * @file oled_region.h
+ * @brief Independent text / bitmap regions (windows) of the oled screen.
+ * Regions stay on top of the canvas in every mode that draws to it (text,
+ * dashboard and console): any renderer drawing outside oled_region.c redraws
+ * the regions it overlapped with oled_region_redraw_overlapping, in the same
+ * oled_graphics_lock hold, so no flush shows a region overwritten. Grayscale
+ * owns the whole screen and shows no regions.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_REGION_H
+#define OLED_REGION_H
+
+#include "graphics.h"
+
+#define OLED_REGION_MAX 8
+#define OLED_REGION_NAME_LENGTH 16
+#define OLED_REGION_TEXT_LENGTH 128
+
+/**
+ * @brief Struct describing one region.
+ * @param name Name of the region, also its directory under
+ * /sys/kernel/oled_sysfs/regions.
+ * @param line First line (page) of the window.
+ * @param position First position (column) of the window.
+ * @param lines Height of the window in lines (pages).
+ * @param columns Width of the window in positions (columns).
+ * @param align Alignment of each text row in the window.
+ * @param font_scale Glyph magnification, 1 (6x8) or 2 (12x16).
+ * @param invert true to draw dark text on a lit background.
+ */
+typedef struct {
+  char name[OLED_REGION_NAME_LENGTH];
+  uint8_t line;
+  uint8_t position;
+  uint8_t lines;
+  uint8_t columns;
+  oled_text_align_t align;
+  uint8_t font_scale;
+  bool invert;
+} oled_region_attrs_t;
+
+/**
+ * @brief Create a region. The window starts out cleared.
+ * @param p_attrs Name and geometry of the region, the remaining attributes
+ * are set to their defaults.
+ * @return Index of the region on success, -EINVAL if the name is empty or the
+ * window does not fit the canvas, -EEXIST if the name is taken, -ENOSPC if
+ * OLED_REGION_MAX regions exist.
+ */
+int oled_region_create(const oled_region_attrs_t *p_attrs);
+
+/**
+ * @brief Remove a region and clear its window.
+ * @param index Index of the region.
+ * @return None.
+ */
+void oled_region_remove(int index);
+
+/**
+ * @brief Look up a region by name.
+ * @param name Name of the region, a trailing newline is ignored.
+ * @return Index of the region, -ENOENT if there is none with that name.
+ */
+int oled_region_find(const char *name);
+
+/**
+ * @brief Get the attributes of a region.
+ * @param index Index of the region.
+ * @param p_attrs Filled with the attributes.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_get_attrs(int index, oled_region_attrs_t *p_attrs);
+
+/**
+ * @brief Change the alignment, font and inversion of a region and redraw it.
+ * @param index Index of the region.
+ * @param p_attrs New attributes, name and geometry are ignored.
+ * @return 0 on success, -EINVAL on an unsupported font_scale, -ENOENT if the
+ * region does not exist.
+ */
+int oled_region_set_style(int index, const oled_region_attrs_t *p_attrs);
+
+/**
+ * @brief Set the text of a region and redraw it.
+ * @param index Index of the region.
+ * @param p_text Text, rows separated by newlines. A single trailing newline is
+ * dropped.
+ * @param text_len Length of p_text, truncated to OLED_REGION_TEXT_LENGTH - 1.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_set_text(int index, const char *p_text, size_t text_len);
+
+/**
+ * @brief Get the text of a region.
+ * @param index Index of the region.
+ * @param p_text Filled with the NUL terminated text, OLED_REGION_TEXT_LENGTH
+ * bytes.
+ * @return 0 on success, -ENOENT if the region does not exist.
+ */
+int oled_region_get_text(int index, char *p_text);
+
+/**
+ * @brief Show a bitmap in a region instead of text.
+ * @param index Index of the region.
+ * @param p_bitmap Page-major bitmap covering the whole window.
+ * @param bitmap_len Must equal lines * columns of the region.
+ * @return 0 on success, -EINVAL on a length mismatch, -ENOENT if the region
+ * does not exist.
+ */
+int oled_region_set_bitmap(int index, const uint8_t *p_bitmap,
+                           size_t bitmap_len);
+
+/**
+ * @brief Redraw all regions into the shadow buffer, e.g. after the canvas has
+ * been cleared.
+ * @param None.
+ * @return None.
+ * @note Regions no longer fitting the canvas are clipped.
+ */
+void oled_region_redraw_all(void);
+
+/**
+ * @brief Redraw the regions overlapping a window of the canvas, after another
+ * renderer drew into it.
+ * @param first_line First line (page) drawn.
+ * @param last_line Last line (page) drawn, inclusive.
+ * @param first_position First position (column) drawn.
+ * @param last_position Last position (column) drawn, inclusive.
+ * @return None.
+ * @note Caller must hold oled_graphics_lock.
+ */
+void oled_region_redraw_overlapping(uint8_t first_line, uint8_t last_line,
+                                    uint8_t first_position,
+                                    uint8_t last_position);
+
+#endif /* OLED_REGION_H */
@@ -0,0 +1,149 @@
+/**
+ * @file oled_shadow_dev.c
+ * @brief /dev/oled_shadow implementation. pwrite(fd, buf, len, offset) copies
+ * page-major bytes straight into the shadow buffer at that offset, without a
+ * bounce buffer, and requests a flush of just the span written. Meant for
+ * clients such as shell scripts that cannot map the frame.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#include "oled_shadow_dev.h"
+#include "graphics.h"
+#include "oled_frame.h"
+
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/mutex.h>
+#include <linux/pagemap.h>
+#include <linux/uaccess.h>
+
+/* Function signatures. */
+static ssize_t oled_shadow_dev_write(struct file *file,
+                                     const char __user *p_buffer, size_t count,
+                                     loff_t *p_offset);
+static loff_t oled_shadow_dev_llseek(struct file *file, loff_t offset,
+                                     int whence);
+
+/**
+ * @brief File operations of /dev/oled_shadow.
+ */
+static const struct file_operations oled_shadow_dev_fops = {
+    .owner = THIS_MODULE,
+    .write = oled_shadow_dev_write,
+    .llseek = oled_shadow_dev_llseek};
+
+/**
+ * @brief /dev/oled_shadow, write-only and root only: writers take
+ * oled_graphics_lock.
+ */
+static struct miscdevice oled_shadow_device = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = "oled_shadow",
+    .fops = &oled_shadow_dev_fops,
+    .mode = 0200};
+
+/**
+ * @brief true once oled_shadow_device has been registered.
+ */
+static bool oled_shadow_device_registered;
+
+/**
+ * @brief write() / pwrite() on /dev/oled_shadow.
+ * @param file Opened device file.
+ * @param p_buffer User buffer, page-major bytes in the canvas layout.
+ * @param count Length of p_buffer, clipped to the end of the frame.
+ * @param p_offset Offset into the shadow buffer, advanced by the bytes
+ * written.
+ * @return Number of bytes written, 0 for an empty write, -ENOSPC at or past
+ * the end of the frame, or -EFAULT if nothing could be copied.
+ * @note The bytes written are flushed at the next frame slot, whether or not
+ * they changed. No user page fault is taken under oled_graphics_lock, a
+ * buffer backed by userfaultfd or FUSE could otherwise stall every renderer
+ * and system suspend: pages are faulted in first and copied with page faults
+ * disabled, a short copy faults in the rest outside the lock and retries.
+ */
+static ssize_t oled_shadow_dev_write(struct file *file,
+                                     const char __user *p_buffer, size_t count,
+                                     loff_t *p_offset) {
+  const size_t frame_length = oled_frame_length();
+  loff_t offset = *p_offset;
+  size_t copied = 0;
+  size_t not_copied;
+  size_t chunk;
+
+  if (count == 0) {
+    return 0;
+  }
+  if ((offset < 0) || (offset >= frame_length)) {
+    return -ENOSPC;
+  }
+  count = min_t(size_t, count, frame_length - offset);
+
+  if (!access_ok(p_buffer, count)) {
+    return -EFAULT;
+  }
+
+  while (copied < count) {
+    if (fault_in_pages_readable(p_buffer + copied, count - copied) != 0) {
+      break;
+    }
+
+    mutex_lock(&oled_graphics_lock);
+    pagefault_disable();
+    not_copied = __copy_from_user_inatomic(
+        &oled_shadow_buffer[offset + copied], p_buffer + copied,
+        count - copied);
+    pagefault_enable();
+    chunk = count - copied - not_copied;
+    oled_mark_range_dirty(offset + copied, chunk);
+    mutex_unlock(&oled_graphics_lock);
+
+    copied += chunk;
+  }
+
+  if (copied == 0) {
+    return -EFAULT;
+  }
+
+  oled_frame_request_flush();
+
+  *p_offset = offset + copied;
+  return copied;
+}
+
+/**
+ * @brief lseek() on /dev/oled_shadow, bounded by the frame length.
+ * @param file Opened device file.
+ * @param offset Offset relative to whence.
+ * @param whence SEEK_SET, SEEK_CUR or SEEK_END.
+ * @return The new offset, or negative errno.
+ */
+static loff_t oled_shadow_dev_llseek(struct file *file, loff_t offset,
+                                     int whence) {
+  return fixed_size_llseek(file, offset, whence, oled_frame_length());
+}
+
+/**
+ * @brief Register /dev/oled_shadow.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_shadow_dev_init(void) {
+  int status_code = misc_register(&oled_shadow_device);
+
+  oled_shadow_device_registered = (status_code == 0);
+  return status_code;
+}
+
+/**
+ * @brief Unregister /dev/oled_shadow.
+ * @param None.
+ * @return None.
+ */
+void oled_shadow_dev_deinit(void) {
+  if (oled_shadow_device_registered) {
+    misc_deregister(&oled_shadow_device);
+    oled_shadow_device_registered = false;
+  }
+}
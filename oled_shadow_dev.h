@@ -0,0 +1,26 @@
+/**
+ * @file oled_shadow_dev.h
+ * @brief /dev/oled_shadow header: write() / pwrite() straight into the shadow
+ * buffer.
+ * @author Luyao Han (luyaohan1001@gmail.com)
+ * @date 12-21-2022
+ */
+
+#ifndef OLED_SHADOW_DEV_H
+#define OLED_SHADOW_DEV_H
+
+/**
+ * @brief Register /dev/oled_shadow.
+ * @param None.
+ * @return 0 on success, negative errno otherwise.
+ */
+int oled_shadow_dev_init(void);
+
+/**
+ * @brief Unregister /dev/oled_shadow.
+ * @param None.
+ * @return None.
+ */
+void oled_shadow_dev_deinit(void);
+
+#endif /* OLED_SHADOW_DEV_H */
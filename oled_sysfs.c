@@ -8,8 +8,15 @@
 
 #include "oled_sysfs.h"
 #include "graphics.h"
+#include "oled_console.h"
+#include "oled_dashboard.h"
+#include "oled_frame.h"
+#include "oled_grayscale.h"
+#include "oled_region.h"
 
+#include <linux/kernel.h>
 #include <linux/kobject.h>
+#include <linux/mutex.h>
 
 /* Function signatures. */
 static ssize_t kobj_attr_display_text_show(struct kobject *kobj,
@@ -18,6 +25,114 @@ static ssize_t kobj_attr_display_text_show(struct kobject *kobj,
 static ssize_t kobj_attr_display_text_store(struct kobject *kobj,
                                             struct kobj_attribute *attr,
                                             const char *buffer, size_t count);
+static ssize_t kobj_attr_max_fps_show(struct kobject *kobj,
+                                      struct kobj_attribute *attr,
+                                      char *buffer);
+static ssize_t kobj_attr_max_fps_store(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       const char *buffer, size_t count);
+static ssize_t kobj_attr_frame_sequence_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer);
+static ssize_t kobj_attr_bus_max_chunk_show(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            char *buffer);
+static ssize_t kobj_attr_bus_max_chunk_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer, size_t count);
+static ssize_t kobj_attr_bus_health_show(struct kobject *kobj,
+                                         struct kobj_attribute *attr,
+                                         char *buffer);
+static ssize_t kobj_attr_display_mode_show(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           char *buffer);
+static ssize_t kobj_attr_display_mode_store(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            const char *buffer, size_t count);
+static ssize_t kobj_attr_grayscale_weighted_show(struct kobject *kobj,
+                                                 struct kobj_attribute *attr,
+                                                 char *buffer);
+static ssize_t kobj_attr_grayscale_weighted_store(struct kobject *kobj,
+                                                  struct kobj_attribute *attr,
+                                                  const char *buffer,
+                                                  size_t count);
+static ssize_t kobj_attr_grayscale_depth_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer);
+static ssize_t kobj_attr_grayscale_depth_store(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               const char *buffer,
+                                               size_t count);
+static ssize_t kobj_attr_grayscale_rate_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer);
+static ssize_t kobj_attr_grayscale_rate_store(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              const char *buffer, size_t count);
+static ssize_t kobj_attr_grayscale_stats_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer);
+static ssize_t kobj_attr_rotation_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buffer);
+static ssize_t kobj_attr_rotation_store(struct kobject *kobj,
+                                        struct kobj_attribute *attr,
+                                        const char *buffer, size_t count);
+static ssize_t bin_attr_grayscale_image_write(struct file *file,
+                                              struct kobject *kobj,
+                                              struct bin_attribute *attr,
+                                              char *buffer, loff_t offset,
+                                              size_t count);
+static ssize_t kobj_attr_dashboard_layout_show(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               char *buffer);
+static ssize_t kobj_attr_dashboard_layout_store(struct kobject *kobj,
+                                                struct kobj_attribute *attr,
+                                                const char *buffer,
+                                                size_t count);
+static ssize_t kobj_attr_dashboard_interval_show(struct kobject *kobj,
+                                                 struct kobj_attribute *attr,
+                                                 char *buffer);
+static ssize_t kobj_attr_dashboard_interval_store(struct kobject *kobj,
+                                                  struct kobj_attribute *attr,
+                                                  const char *buffer,
+                                                  size_t count);
+static ssize_t kobj_attr_console_printk_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer);
+static ssize_t kobj_attr_console_printk_store(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              const char *buffer,
+                                              size_t count);
+static ssize_t kobj_attr_console_lines_show(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            char *buffer);
+static ssize_t kobj_attr_region_create_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer, size_t count);
+static ssize_t kobj_attr_region_remove_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer, size_t count);
+static ssize_t kobj_attr_region_text_show(struct kobject *kobj,
+                                          struct kobj_attribute *attr,
+                                          char *buffer);
+static ssize_t kobj_attr_region_text_store(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           const char *buffer, size_t count);
+static ssize_t kobj_attr_region_style_show(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           char *buffer);
+static ssize_t kobj_attr_region_style_store(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            const char *buffer, size_t count);
+static ssize_t kobj_attr_region_geometry_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer);
+static ssize_t bin_attr_region_bitmap_write(struct file *file,
+                                            struct kobject *kobj,
+                                            struct bin_attribute *attr,
+                                            char *buffer, loff_t offset,
+                                            size_t count);
 
 /**
  * @brief The pointer storing a oled kernel object to be created later.
@@ -41,6 +156,345 @@ static struct kobj_attribute kobj_attr_display_text = {
     .show = kobj_attr_display_text_show,
     .store = kobj_attr_display_text_store};
 
+/**
+ * @brief "max_fps" attribute, the upper bound of frames per second flushed to
+ * the screen. Updates arriving within one frame interval are coalesced.
+ */
+static struct kobj_attribute kobj_attr_max_fps = {
+    .attr = {.name = "max_fps", .mode = 0644},
+    .show = kobj_attr_max_fps_show,
+    .store = kobj_attr_max_fps_store};
+
+/**
+ * @brief "frame_sequence" attribute, the sequence number of the last frame
+ * that reached the screen.
+ * @note  Pollable: poll() / select() on this file returns POLLPRI | POLLERR
+ * whenever a flush completes. Re-read the file (from offset 0) to re-arm.
+ */
+static struct kobj_attribute kobj_attr_frame_sequence = {
+    .attr = {.name = "frame_sequence", .mode = 0444},
+    .show = kobj_attr_frame_sequence_show,
+    .store = NULL};
+
+/**
+ * @brief "bus_max_chunk" attribute, the maximum number of bytes a frame flush
+ * transfers under one I2C adapter lock hold. Smaller values bound the latency
+ * other devices on a shared bus see, larger values reduce flush overhead.
+ */
+static struct kobj_attribute kobj_attr_bus_max_chunk = {
+    .attr = {.name = "bus_max_chunk", .mode = 0644},
+    .show = kobj_attr_bus_max_chunk_show,
+    .store = kobj_attr_bus_max_chunk_store};
+
+/**
+ * @brief Read-only bus health counters, all served by
+ * kobj_attr_bus_health_show.
+ * @note  "bus_errors": failed transfers, retries included.
+ *        "bus_retries": transfers retried after a backoff.
+ *        "bus_failed_batches": batches dropped after exhausting retries.
+ *        "bus_degraded": 1 while the panel is considered unreachable.
+ */
+static struct kobj_attribute kobj_attr_bus_errors = {
+    .attr = {.name = "bus_errors", .mode = 0444},
+    .show = kobj_attr_bus_health_show,
+    .store = NULL};
+
+static struct kobj_attribute kobj_attr_bus_retries = {
+    .attr = {.name = "bus_retries", .mode = 0444},
+    .show = kobj_attr_bus_health_show,
+    .store = NULL};
+
+static struct kobj_attribute kobj_attr_bus_failed_batches = {
+    .attr = {.name = "bus_failed_batches", .mode = 0444},
+    .show = kobj_attr_bus_health_show,
+    .store = NULL};
+
+static struct kobj_attribute kobj_attr_bus_degraded = {
+    .attr = {.name = "bus_degraded", .mode = 0444},
+    .show = kobj_attr_bus_health_show,
+    .store = NULL};
+
+/**
+ * @brief "display_mode" attribute, selecting what owns the screen: "text" or
+ * "grayscale".
+ */
+static struct kobj_attribute kobj_attr_display_mode = {
+    .attr = {.name = "display_mode", .mode = 0644},
+    .show = kobj_attr_display_mode_show,
+    .store = kobj_attr_display_mode_store};
+
+/**
+ * @brief "grayscale_weighted" attribute, 1 to show one contrast weighted
+ * bitplane per bit of depth instead of thermometer coded subframes. Applies to
+ * the next image written to grayscale_image.
+ */
+static struct kobj_attribute kobj_attr_grayscale_weighted = {
+    .attr = {.name = "grayscale_weighted", .mode = 0644},
+    .show = kobj_attr_grayscale_weighted_show,
+    .store = kobj_attr_grayscale_weighted_store};
+
+/**
+ * @brief "grayscale_depth" attribute, bits per pixel (2 or 4) of the next
+ * image written to grayscale_image.
+ */
+static struct kobj_attribute kobj_attr_grayscale_depth = {
+    .attr = {.name = "grayscale_depth", .mode = 0644},
+    .show = kobj_attr_grayscale_depth_show,
+    .store = kobj_attr_grayscale_depth_store};
+
+/**
+ * @brief "grayscale_rate" attribute, target subframes per second, 180 by
+ * default. 0 benchmarks the transport, running as fast as it allows.
+ */
+static struct kobj_attribute kobj_attr_grayscale_rate = {
+    .attr = {.name = "grayscale_rate", .mode = 0644},
+    .show = kobj_attr_grayscale_rate_show,
+    .store = kobj_attr_grayscale_rate_store};
+
+/**
+ * @brief "grayscale_stats" attribute, reporting the achieved frame-rate
+ * modulation rate per transport.
+ */
+static struct kobj_attribute kobj_attr_grayscale_stats = {
+    .attr = {.name = "grayscale_stats", .mode = 0444},
+    .show = kobj_attr_grayscale_stats_show,
+    .store = NULL};
+
+/**
+ * @brief "rotation" attribute, orientation of the canvas on the panel: "0",
+ * "90", "180", "270", "mirror-x" or "mirror-y".
+ */
+static struct kobj_attribute kobj_attr_rotation = {
+    .attr = {.name = "rotation", .mode = 0644},
+    .show = kobj_attr_rotation_show,
+    .store = kobj_attr_rotation_store};
+
+/**
+ * @brief "grayscale_image" binary attribute, taking a row-major image of
+ * grayscale_depth bits per pixel, e.g. 2048 or 4096 bytes on a 128x64 panel.
+ */
+static struct bin_attribute bin_attr_grayscale_image = {
+    .attr = {.name = "grayscale_image", .mode = 0200},
+    .size = OLED_GRAYSCALE_4BPP_LENGTH,
+    .write = bin_attr_grayscale_image_write};
+
+/**
+ * @brief "dashboard_layout" attribute, the layout shown while display_mode is
+ * "dashboard", with "{source}" fields bound to kernel sources.
+ */
+static struct kobj_attribute kobj_attr_dashboard_layout = {
+    .attr = {.name = "dashboard_layout", .mode = 0644},
+    .show = kobj_attr_dashboard_layout_show,
+    .store = kobj_attr_dashboard_layout_store};
+
+/**
+ * @brief "dashboard_interval_ms" attribute, the sampling period of the
+ * dashboard sources.
+ */
+static struct kobj_attribute kobj_attr_dashboard_interval = {
+    .attr = {.name = "dashboard_interval_ms", .mode = 0644},
+    .show = kobj_attr_dashboard_interval_show,
+    .store = kobj_attr_dashboard_interval_store};
+
+/**
+ * @brief "console_printk" attribute, 1 to mirror kernel log messages into
+ * the console shown while display_mode is "console".
+ */
+static struct kobj_attribute kobj_attr_console_printk = {
+    .attr = {.name = "console_printk", .mode = 0644},
+    .show = kobj_attr_console_printk_show,
+    .store = kobj_attr_console_printk_store};
+
+/**
+ * @brief "console_lines" attribute, the number of lines pushed into the
+ * console.
+ */
+static struct kobj_attribute kobj_attr_console_lines = {
+    .attr = {.name = "console_lines", .mode = 0444},
+    .show = kobj_attr_console_lines_show,
+    .store = NULL};
+
+/**
+ * @brief "create" attribute of the regions directory, taking
+ * "name line position lines columns" to create a region.
+ */
+static struct kobj_attribute kobj_attr_region_create = {
+    .attr = {.name = "create", .mode = 0200},
+    .show = NULL,
+    .store = kobj_attr_region_create_store};
+
+/**
+ * @brief "remove" attribute of the regions directory, taking the name of the
+ * region to remove.
+ */
+static struct kobj_attribute kobj_attr_region_remove = {
+    .attr = {.name = "remove", .mode = 0200},
+    .show = NULL,
+    .store = kobj_attr_region_remove_store};
+
+/**
+ * @brief "text" attribute of a region, rows separated by newlines.
+ */
+static struct kobj_attribute kobj_attr_region_text = {
+    .attr = {.name = "text", .mode = 0644},
+    .show = kobj_attr_region_text_show,
+    .store = kobj_attr_region_text_store};
+
+/**
+ * @brief "align" attribute of a region: "left", "center" or "right".
+ */
+static struct kobj_attribute kobj_attr_region_align = {
+    .attr = {.name = "align", .mode = 0644},
+    .show = kobj_attr_region_style_show,
+    .store = kobj_attr_region_style_store};
+
+/**
+ * @brief "font" attribute of a region: "6x8" or "12x16".
+ */
+static struct kobj_attribute kobj_attr_region_font = {
+    .attr = {.name = "font", .mode = 0644},
+    .show = kobj_attr_region_style_show,
+    .store = kobj_attr_region_style_store};
+
+/**
+ * @brief "invert" attribute of a region, 1 for dark text on a lit background.
+ */
+static struct kobj_attribute kobj_attr_region_invert = {
+    .attr = {.name = "invert", .mode = 0644},
+    .show = kobj_attr_region_style_show,
+    .store = kobj_attr_region_style_store};
+
+/**
+ * @brief "geometry" attribute of a region, "line position lines columns".
+ */
+static struct kobj_attribute kobj_attr_region_geometry = {
+    .attr = {.name = "geometry", .mode = 0444},
+    .show = kobj_attr_region_geometry_show,
+    .store = NULL};
+
+/**
+ * @brief "bitmap" binary attribute of a region, taking a page-major bitmap of
+ * exactly lines * columns bytes in a single write.
+ */
+static struct bin_attribute bin_attr_region_bitmap = {
+    .attr = {.name = "bitmap", .mode = 0200},
+    .size = OLED_FRAME_LENGTH,
+    .write = bin_attr_region_bitmap_write};
+
+/**
+ * @brief The /sys/kernel/oled_sysfs/regions directory.
+ */
+static struct kobject *regions_kobj;
+
+/**
+ * @brief Directory of each region, indexed like the regions in oled_region.c.
+ * @note Written under region_kobj_lock, read locklessly by the attribute
+ * callbacks of the regions: a directory is removed, waiting for its callbacks
+ * to finish, before its slot is cleared.
+ */
+static struct kobject *region_kobjs[OLED_REGION_MAX];
+
+/**
+ * @brief Serializes creation and removal of regions.
+ */
+static DEFINE_MUTEX(region_kobj_lock);
+
+/**
+ * @brief Serializes display_mode changes.
+ */
+static DEFINE_MUTEX(display_mode_lock);
+
+/**
+ * @brief Names of oled_display_mode_t values, as read from / written to
+ * display_mode.
+ */
+static const char *const display_mode_names[] = {
+    [OLED_MODE_TEXT] = "text",
+    [OLED_MODE_GRAYSCALE] = "grayscale",
+    [OLED_MODE_DASHBOARD] = "dashboard",
+    [OLED_MODE_CONSOLE] = "console",
+};
+
+/**
+ * @brief Names of oled_rotation_t values, as read from / written to rotation.
+ */
+static const char *const rotation_names[] = {
+    [OLED_ROTATION_0] = "0",
+    [OLED_ROTATION_90] = "90",
+    [OLED_ROTATION_180] = "180",
+    [OLED_ROTATION_270] = "270",
+    [OLED_MIRROR_X] = "mirror-x",
+    [OLED_MIRROR_Y] = "mirror-y",
+};
+
+/**
+ * @brief Names of oled_text_align_t values, as read from / written to align.
+ */
+static const char *const align_names[] = {[OLED_ALIGN_LEFT] = "left",
+                                          [OLED_ALIGN_CENTER] = "center",
+                                          [OLED_ALIGN_RIGHT] = "right"};
+
+/**
+ * @brief Names of the font scales, as read from / written to font. Entry i
+ * names font_scale i + 1.
+ */
+static const char *const font_names[OLED_FONT_SCALE_MAX] = {"6x8", "12x16"};
+
+/**
+ * @brief All attribute files created under /sys/kernel/oled_sysfs.
+ */
+static struct attribute *oled_attrs[] = {&kobj_attr_display_text.attr,
+                                         &kobj_attr_max_fps.attr,
+                                         &kobj_attr_frame_sequence.attr,
+                                         &kobj_attr_bus_max_chunk.attr,
+                                         &kobj_attr_bus_errors.attr,
+                                         &kobj_attr_bus_retries.attr,
+                                         &kobj_attr_bus_failed_batches.attr,
+                                         &kobj_attr_bus_degraded.attr,
+                                         &kobj_attr_display_mode.attr,
+                                         &kobj_attr_grayscale_weighted.attr,
+                                         &kobj_attr_grayscale_depth.attr,
+                                         &kobj_attr_grayscale_rate.attr,
+                                         &kobj_attr_grayscale_stats.attr,
+                                         &kobj_attr_rotation.attr,
+                                         &kobj_attr_dashboard_layout.attr,
+                                         &kobj_attr_dashboard_interval.attr,
+                                         &kobj_attr_console_printk.attr,
+                                         &kobj_attr_console_lines.attr,
+                                         NULL};
+
+static struct bin_attribute *oled_bin_attrs[] = {&bin_attr_grayscale_image,
+                                                 NULL};
+
+static const struct attribute_group oled_attr_group = {
+    .attrs = oled_attrs, .bin_attrs = oled_bin_attrs};
+
+/**
+ * @brief Attribute files created under /sys/kernel/oled_sysfs/regions.
+ */
+static struct attribute *regions_attrs[] = {&kobj_attr_region_create.attr,
+                                            &kobj_attr_region_remove.attr,
+                                            NULL};
+
+static const struct attribute_group regions_attr_group = {
+    .attrs = regions_attrs};
+
+/**
+ * @brief Attribute files created in the directory of each region.
+ */
+static struct attribute *region_attrs[] = {&kobj_attr_region_text.attr,
+                                           &kobj_attr_region_align.attr,
+                                           &kobj_attr_region_font.attr,
+                                           &kobj_attr_region_invert.attr,
+                                           &kobj_attr_region_geometry.attr,
+                                           NULL};
+
+static struct bin_attribute *region_bin_attrs[] = {&bin_attr_region_bitmap,
+                                                   NULL};
+
+static const struct attribute_group region_attr_group = {
+    .attrs = region_attrs, .bin_attrs = region_bin_attrs};
+
 /**
  * @brief Callback function prototype for when the user read display_text, i.e.
  * cat /sys/kernel/oled_sysfs/display_text. The prototype implements the
@@ -95,6 +549,791 @@ static ssize_t kobj_attr_display_text_store(struct kobject *kobj,
   return count;
 }
 
+/**
+ * @brief Callback for reading max_fps, i.e.
+ * cat /sys/kernel/oled_sysfs/max_fps.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the frame rate to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_max_fps_show(struct kobject *kobj,
+                                      struct kobj_attribute *attr,
+                                      char *buffer) {
+  return sprintf(buffer, "%u\n", oled_frame_get_max_fps());
+}
+
+/**
+ * @brief Callback for writing max_fps, i.e.
+ * echo 20 > /sys/kernel/oled_sysfs/max_fps.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Frame rate in decimal.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_max_fps_store(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       const char *buffer, size_t count) {
+  unsigned int max_fps;
+
+  if (kstrtouint(buffer, 10, &max_fps) != 0 || max_fps == 0) {
+    return -EINVAL;
+  }
+
+  oled_frame_set_max_fps(max_fps);
+  return count;
+}
+
+/**
+ * @brief Callback for reading frame_sequence, i.e.
+ * cat /sys/kernel/oled_sysfs/frame_sequence.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the sequence number to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_frame_sequence_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer) {
+  return sprintf(buffer, "%u\n", oled_frame_get_sequence());
+}
+
+/**
+ * @brief Callback for reading bus_max_chunk, i.e.
+ * cat /sys/kernel/oled_sysfs/bus_max_chunk.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the byte count to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_bus_max_chunk_show(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            char *buffer) {
+  return sprintf(buffer, "%u\n", ssd1306_get_bus_max_chunk());
+}
+
+/**
+ * @brief Callback for writing bus_max_chunk, i.e.
+ * echo 128 > /sys/kernel/oled_sysfs/bus_max_chunk.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Byte count in decimal.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_bus_max_chunk_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer, size_t count) {
+  unsigned int max_chunk;
+
+  if (kstrtouint(buffer, 10, &max_chunk) != 0) {
+    return -EINVAL;
+  }
+
+  ssd1306_set_bus_max_chunk(max_chunk);
+  return count;
+}
+
+/**
+ * @brief Callback for reading any of the bus health counters, i.e.
+ * cat /sys/kernel/oled_sysfs/bus_errors.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show), selects
+ * the counter.
+ * @param buffer Buffer to print the counter to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_bus_health_show(struct kobject *kobj,
+                                         struct kobj_attribute *attr,
+                                         char *buffer) {
+  ssd1306_bus_health_t health;
+  u32 value = 0;
+
+  ssd1306_get_bus_health(&health);
+
+  if (attr == &kobj_attr_bus_errors) {
+    value = health.transfer_errors;
+  } else if (attr == &kobj_attr_bus_retries) {
+    value = health.retries;
+  } else if (attr == &kobj_attr_bus_failed_batches) {
+    value = health.failed_batches;
+  } else if (attr == &kobj_attr_bus_degraded) {
+    value = health.degraded;
+  }
+
+  return sprintf(buffer, "%u\n", value);
+}
+
+/**
+ * @brief Stop whatever owns the screen besides the text canvas.
+ * @param None.
+ * @return None.
+ * @note Caller must hold display_mode_lock and set display_mode afterwards.
+ */
+static void oled_display_mode_leave(void) {
+  if (oled_graphics_params.display_mode == OLED_MODE_GRAYSCALE) {
+    oled_grayscale_stop();
+  } else if (oled_graphics_params.display_mode == OLED_MODE_DASHBOARD) {
+    oled_dashboard_stop();
+  } else if (oled_graphics_params.display_mode == OLED_MODE_CONSOLE) {
+    oled_console_stop();
+  }
+}
+
+/**
+ * @brief Callback for reading display_mode, i.e.
+ * cat /sys/kernel/oled_sysfs/display_mode.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the mode name to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_display_mode_show(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           char *buffer) {
+  return sprintf(buffer, "%s\n",
+                 display_mode_names[oled_graphics_params.display_mode]);
+}
+
+/**
+ * @brief Callback for writing display_mode, i.e.
+ * echo grayscale > /sys/kernel/oled_sysfs/display_mode.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Mode name.
+ * @return Number of characters written, or negative errno if the mode could
+ * not be entered.
+ */
+static ssize_t kobj_attr_display_mode_store(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            const char *buffer, size_t count) {
+  int mode = sysfs_match_string(display_mode_names, buffer);
+  int status_code = 0;
+
+  if (mode < 0) {
+    return -EINVAL;
+  }
+
+  mutex_lock(&display_mode_lock);
+
+  if (mode != oled_graphics_params.display_mode) {
+    oled_display_mode_leave();
+
+    /* Enter the new mode. */
+    if (mode == OLED_MODE_GRAYSCALE) {
+      status_code = oled_grayscale_start();
+    } else if (mode == OLED_MODE_DASHBOARD) {
+      status_code = oled_dashboard_start();
+    } else if (mode == OLED_MODE_CONSOLE) {
+      status_code = oled_console_start();
+    }
+
+    oled_graphics_params.display_mode =
+        (status_code == 0) ? mode : OLED_MODE_TEXT;
+  }
+
+  mutex_unlock(&display_mode_lock);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading rotation, i.e.
+ * cat /sys/kernel/oled_sysfs/rotation.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the rotation name to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_rotation_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buffer) {
+  return sprintf(buffer, "%s\n",
+                 rotation_names[oled_graphics_params.rotation]);
+}
+
+/**
+ * @brief Callback for writing rotation, i.e.
+ * echo 90 > /sys/kernel/oled_sysfs/rotation.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Rotation name.
+ * @return Number of characters written, -EINVAL on an unknown rotation, or
+ * -EBUSY while grayscale owns the screen, as its bitplanes are built for the
+ * orientation at load time.
+ */
+static ssize_t kobj_attr_rotation_store(struct kobject *kobj,
+                                        struct kobj_attribute *attr,
+                                        const char *buffer, size_t count) {
+  int rotation = sysfs_match_string(rotation_names, buffer);
+  int status_code = 0;
+
+  if (rotation < 0) {
+    return -EINVAL;
+  }
+
+  mutex_lock(&display_mode_lock);
+
+  if (oled_graphics_params.display_mode != OLED_MODE_TEXT) {
+    status_code = -EBUSY;
+    goto RETURN;
+  }
+
+  mutex_lock(&oled_graphics_lock);
+  oled_set_rotation(rotation);
+  mutex_unlock(&oled_graphics_lock);
+
+  /* A change to portrait clears the canvas. */
+  oled_region_redraw_all();
+
+  /* Program the new scan directions and redraw the frame. */
+  oled_frame_request_reinit();
+
+RETURN:
+  mutex_unlock(&display_mode_lock);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading grayscale_weighted.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print 0 or 1 to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_grayscale_weighted_show(struct kobject *kobj,
+                                                 struct kobj_attribute *attr,
+                                                 char *buffer) {
+  return sprintf(buffer, "%d\n", oled_grayscale_get_weighted());
+}
+
+/**
+ * @brief Callback for writing grayscale_weighted.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Boolean, e.g. 0 or 1.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_grayscale_weighted_store(struct kobject *kobj,
+                                                  struct kobj_attribute *attr,
+                                                  const char *buffer,
+                                                  size_t count) {
+  bool weighted;
+
+  if (kstrtobool(buffer, &weighted) != 0) {
+    return -EINVAL;
+  }
+
+  oled_grayscale_set_weighted(weighted);
+  return count;
+}
+
+/**
+ * @brief Callback for reading grayscale_depth.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the bits per pixel to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_grayscale_depth_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer) {
+  return sprintf(buffer, "%u\n", oled_grayscale_get_depth());
+}
+
+/**
+ * @brief Callback for writing grayscale_depth, i.e.
+ * echo 4 > /sys/kernel/oled_sysfs/grayscale_depth.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Bits per pixel in decimal, 2 or 4.
+ * @return Number of characters written, or -EINVAL on any other depth.
+ */
+static ssize_t kobj_attr_grayscale_depth_store(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               const char *buffer,
+                                               size_t count) {
+  unsigned int bits_per_pixel;
+  int status_code;
+
+  if (kstrtouint(buffer, 10, &bits_per_pixel) != 0) {
+    return -EINVAL;
+  }
+
+  status_code = oled_grayscale_set_depth(bits_per_pixel);
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading grayscale_rate.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the rate to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_grayscale_rate_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer) {
+  return sprintf(buffer, "%u\n", oled_grayscale_get_rate());
+}
+
+/**
+ * @brief Callback for writing grayscale_rate.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Subframes per second in decimal.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_grayscale_rate_store(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              const char *buffer,
+                                              size_t count) {
+  unsigned int rate;
+
+  if (kstrtouint(buffer, 10, &rate) != 0) {
+    return -EINVAL;
+  }
+
+  oled_grayscale_set_rate(rate);
+  return count;
+}
+
+/**
+ * @brief Callback for reading grayscale_stats, i.e.
+ * cat /sys/kernel/oled_sysfs/grayscale_stats.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the statistics to.
+ * @return Number of characters printed.
+ * @note With grayscale_rate set to 0, subframes_per_sec is the achievable
+ * modulation rate of the transport.
+ */
+static ssize_t kobj_attr_grayscale_stats_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer) {
+  oled_grayscale_stats_t stats;
+
+  oled_grayscale_get_stats(&stats);
+
+  return sprintf(buffer,
+                 "transport: %s\nplanes: %u\nsubframes: %llu\n"
+                 "subframes_per_sec: %u\nflush_us_avg: %u\n"
+                 "flush_us_max: %u\n",
+                 stats.transport, stats.planes,
+                 (unsigned long long)stats.subframes, stats.subframes_per_sec,
+                 stats.flush_us_avg, stats.flush_us_max);
+}
+
+/**
+ * @brief Callback for writing grayscale_image, i.e.
+ * cat image.gray2 > /sys/kernel/oled_sysfs/grayscale_image.
+ * @param file Opened sysfs file.
+ * @param kobj Kobject to which tied sysfs file is written.
+ * @param attr Binary attribute to which the tied sysfs file is written.
+ * @param buffer Chunk of the image.
+ * @param offset Offset of the chunk within the image.
+ * @param count Length of the chunk.
+ * @return Number of bytes written, or negative errno.
+ * @note The image is converted to bitplanes once a write ends at exactly the
+ * image length of the panel at grayscale_depth, so it may arrive in chunks.
+ */
+static ssize_t bin_attr_grayscale_image_write(struct file *file,
+                                              struct kobject *kobj,
+                                              struct bin_attribute *attr,
+                                              char *buffer, loff_t offset,
+                                              size_t count) {
+  static u8 image[OLED_GRAYSCALE_4BPP_LENGTH];
+  static DEFINE_MUTEX(image_lock);
+  size_t image_len = offset + count;
+  size_t frame_length = oled_frame_length();
+  int status_code = 0;
+
+  mutex_lock(&image_lock);
+
+  memcpy(&image[offset], buffer, count);
+
+  if (image_len == frame_length * oled_grayscale_get_depth()) {
+    status_code = oled_grayscale_load(image, image_len);
+  }
+
+  mutex_unlock(&image_lock);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading dashboard_layout.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the layout to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_dashboard_layout_show(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               char *buffer) {
+  char layout[OLED_DASHBOARD_LAYOUT_LENGTH];
+
+  oled_dashboard_get_layout(layout);
+  return sprintf(buffer, "%s", layout);
+}
+
+/**
+ * @brief Callback for writing dashboard_layout, i.e.
+ * printf 'load {load1}\nmem {memavail}\n' >
+ * /sys/kernel/oled_sysfs/dashboard_layout.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer The layout, see oled_dashboard.h.
+ * @return Number of characters written, or negative errno on a malformed
+ * layout.
+ */
+static ssize_t kobj_attr_dashboard_layout_store(struct kobject *kobj,
+                                                struct kobj_attribute *attr,
+                                                const char *buffer,
+                                                size_t count) {
+  int status_code = oled_dashboard_set_layout(buffer, count);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading dashboard_interval_ms.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the period to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_dashboard_interval_show(struct kobject *kobj,
+                                                 struct kobj_attribute *attr,
+                                                 char *buffer) {
+  return sprintf(buffer, "%u\n", oled_dashboard_get_interval());
+}
+
+/**
+ * @brief Callback for writing dashboard_interval_ms.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Milliseconds in decimal.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_dashboard_interval_store(struct kobject *kobj,
+                                                  struct kobj_attribute *attr,
+                                                  const char *buffer,
+                                                  size_t count) {
+  unsigned int interval_ms;
+
+  if (kstrtouint(buffer, 10, &interval_ms) != 0) {
+    return -EINVAL;
+  }
+
+  oled_dashboard_set_interval(interval_ms);
+  return count;
+}
+
+/**
+ * @brief Callback for reading console_printk.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print 0 or 1 to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_console_printk_show(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             char *buffer) {
+  return sprintf(buffer, "%d\n", oled_console_get_printk());
+}
+
+/**
+ * @brief Callback for writing console_printk.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Boolean, e.g. 0 or 1.
+ * @return Number of characters written, or -EINVAL on malformed input.
+ */
+static ssize_t kobj_attr_console_printk_store(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              const char *buffer,
+                                              size_t count) {
+  bool enable;
+
+  if (kstrtobool(buffer, &enable) != 0) {
+    return -EINVAL;
+  }
+
+  oled_console_set_printk(enable);
+  return count;
+}
+
+/**
+ * @brief Callback for reading console_lines.
+ * @param kobj Kobject to which tied sysfs file is read (show).
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the line count to.
+ * @return Number of characters printed.
+ */
+static ssize_t kobj_attr_console_lines_show(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            char *buffer) {
+  return sprintf(buffer, "%lu\n", oled_console_get_lines());
+}
+
+/**
+ * @brief Find the region a directory belongs to.
+ * @param kobj Directory of the region.
+ * @return Index of the region, -ENOENT if the directory is not a region's.
+ */
+static int region_index_of(struct kobject *kobj) {
+  int index;
+
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (READ_ONCE(region_kobjs[index]) == kobj) {
+      return index;
+    }
+  }
+  return -ENOENT;
+}
+
+/**
+ * @brief Callback for creating a region, i.e.
+ * echo "clock 0 80 1 48" > /sys/kernel/oled_sysfs/regions/create.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer "name line position lines columns", in lines (pages) and
+ * positions (columns).
+ * @return Number of characters written, or negative errno.
+ */
+static ssize_t kobj_attr_region_create_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer,
+                                             size_t count) {
+  oled_region_attrs_t attrs = {0};
+  struct kobject *region_kobj;
+  int index;
+  int status_code = 0;
+
+  if (sscanf(buffer, "%15s %hhu %hhu %hhu %hhu", attrs.name, &attrs.line,
+             &attrs.position, &attrs.lines, &attrs.columns) != 5) {
+    return -EINVAL;
+  }
+
+  mutex_lock(&region_kobj_lock);
+
+  index = oled_region_create(&attrs);
+  if (index < 0) {
+    status_code = index;
+    goto RETURN;
+  }
+
+  region_kobj = kobject_create_and_add(attrs.name, regions_kobj);
+  if (NULL == region_kobj) {
+    oled_region_remove(index);
+    status_code = -ENOMEM;
+    goto RETURN;
+  }
+
+  WRITE_ONCE(region_kobjs[index], region_kobj);
+
+  status_code = sysfs_create_group(region_kobj, &region_attr_group);
+  if (status_code != 0) {
+    kobject_put(region_kobj);
+    WRITE_ONCE(region_kobjs[index], NULL);
+    oled_region_remove(index);
+  }
+
+RETURN:
+  mutex_unlock(&region_kobj_lock);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Remove the directory of a region, then the region itself.
+ * @param index Index of the region.
+ * @return None.
+ * @note Caller must hold region_kobj_lock.
+ */
+static void region_kobj_remove(int index) {
+  /* Waits for callbacks running on the region's attributes. */
+  kobject_put(region_kobjs[index]);
+  WRITE_ONCE(region_kobjs[index], NULL);
+  oled_region_remove(index);
+}
+
+/**
+ * @brief Callback for removing a region, i.e.
+ * echo clock > /sys/kernel/oled_sysfs/regions/remove.
+ * @param kobj Kobject to which tied sysfs file is written (store).
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Name of the region.
+ * @return Number of characters written, or -ENOENT on an unknown region.
+ */
+static ssize_t kobj_attr_region_remove_store(struct kobject *kobj,
+                                             struct kobj_attribute *attr,
+                                             const char *buffer,
+                                             size_t count) {
+  int index;
+
+  mutex_lock(&region_kobj_lock);
+
+  index = oled_region_find(buffer);
+  if (index >= 0) {
+    region_kobj_remove(index);
+  }
+
+  mutex_unlock(&region_kobj_lock);
+
+  return (index >= 0) ? count : index;
+}
+
+/**
+ * @brief Callback for reading the text of a region.
+ * @param kobj Directory of the region.
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the text to.
+ * @return Number of characters printed, or negative errno.
+ */
+static ssize_t kobj_attr_region_text_show(struct kobject *kobj,
+                                          struct kobj_attribute *attr,
+                                          char *buffer) {
+  char text[OLED_REGION_TEXT_LENGTH];
+  int status_code = oled_region_get_text(region_index_of(kobj), text);
+
+  if (status_code != 0) {
+    return status_code;
+  }
+  return sprintf(buffer, "%s\n", text);
+}
+
+/**
+ * @brief Callback for writing the text of a region, i.e.
+ * echo 12:34 > /sys/kernel/oled_sysfs/regions/clock/text. Only the region's
+ * window is redrawn.
+ * @param kobj Directory of the region.
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Text, rows separated by newlines.
+ * @return Number of characters written, or negative errno.
+ */
+static ssize_t kobj_attr_region_text_store(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           const char *buffer, size_t count) {
+  int status_code =
+      oled_region_set_text(region_index_of(kobj), buffer, count);
+
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading align, font or invert of a region.
+ * @param kobj Directory of the region.
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print the value to.
+ * @return Number of characters printed, or negative errno.
+ */
+static ssize_t kobj_attr_region_style_show(struct kobject *kobj,
+                                           struct kobj_attribute *attr,
+                                           char *buffer) {
+  oled_region_attrs_t attrs;
+  int status_code = oled_region_get_attrs(region_index_of(kobj), &attrs);
+
+  if (status_code != 0) {
+    return status_code;
+  }
+
+  if (attr == &kobj_attr_region_align) {
+    return sprintf(buffer, "%s\n", align_names[attrs.align]);
+  } else if (attr == &kobj_attr_region_font) {
+    return sprintf(buffer, "%s\n", font_names[attrs.font_scale - 1]);
+  } else {
+    return sprintf(buffer, "%d\n", attrs.invert);
+  }
+}
+
+/**
+ * @brief Callback for writing align, font or invert of a region.
+ * @param kobj Directory of the region.
+ * @param attr Attribute to which the tied sysfs file is written (store).
+ * @param buffer Alignment name, font name or boolean.
+ * @return Number of characters written, or negative errno.
+ */
+static ssize_t kobj_attr_region_style_store(struct kobject *kobj,
+                                            struct kobj_attribute *attr,
+                                            const char *buffer, size_t count) {
+  const int index = region_index_of(kobj);
+  oled_region_attrs_t attrs;
+  int value;
+  int status_code = oled_region_get_attrs(index, &attrs);
+
+  if (status_code != 0) {
+    return status_code;
+  }
+
+  if (attr == &kobj_attr_region_align) {
+    value = sysfs_match_string(align_names, buffer);
+    if (value < 0) {
+      return -EINVAL;
+    }
+    attrs.align = value;
+  } else if (attr == &kobj_attr_region_font) {
+    value = sysfs_match_string(font_names, buffer);
+    if (value < 0) {
+      return -EINVAL;
+    }
+    attrs.font_scale = value + 1;
+  } else if (kstrtobool(buffer, &attrs.invert) != 0) {
+    return -EINVAL;
+  }
+
+  status_code = oled_region_set_style(index, &attrs);
+  return (status_code == 0) ? count : status_code;
+}
+
+/**
+ * @brief Callback for reading the geometry of a region.
+ * @param kobj Directory of the region.
+ * @param attr Attribute to which the tied sysfs file is read (show).
+ * @param buffer Buffer to print "line position lines columns" to.
+ * @return Number of characters printed, or negative errno.
+ */
+static ssize_t kobj_attr_region_geometry_show(struct kobject *kobj,
+                                              struct kobj_attribute *attr,
+                                              char *buffer) {
+  oled_region_attrs_t attrs;
+  int status_code = oled_region_get_attrs(region_index_of(kobj), &attrs);
+
+  if (status_code != 0) {
+    return status_code;
+  }
+  return sprintf(buffer, "%u %u %u %u\n", attrs.line, attrs.position,
+                 attrs.lines, attrs.columns);
+}
+
+/**
+ * @brief Callback for writing the bitmap of a region, i.e.
+ * cat icon.bin > /sys/kernel/oled_sysfs/regions/icon/bitmap.
+ * @param file Opened sysfs file.
+ * @param kobj Directory of the region.
+ * @param attr Binary attribute to which the tied sysfs file is written.
+ * @param buffer The bitmap.
+ * @param offset Must be 0, the bitmap is taken in a single write.
+ * @param count Must be lines * columns of the region.
+ * @return Number of bytes written, or negative errno.
+ */
+static ssize_t bin_attr_region_bitmap_write(struct file *file,
+                                            struct kobject *kobj,
+                                            struct bin_attribute *attr,
+                                            char *buffer, loff_t offset,
+                                            size_t count) {
+  int status_code;
+
+  if (offset != 0) {
+    return -EINVAL;
+  }
+
+  status_code = oled_region_set_bitmap(region_index_of(kobj),
+                                       (const uint8_t *)buffer, count);
+  return (status_code == 0) ? count : status_code;
+}
+
 /**
  * @brief Creates kobject and its attributes under sysfs.
  * @param None.
@@ -119,14 +1358,31 @@ int oled_sysfs_init(void) {
     goto RETURN;
   }
 
-  /* Create file under oled_sysfs directory. */;
-  status_code = sysfs_create_file(oled_kobj, &kobj_attr_display_text.attr);
+  /* Create files under oled_sysfs directory. */
+  status_code = sysfs_create_group(oled_kobj, &oled_attr_group);
 
   if (status_code != 0) {
-    pr_err("Error creating sysfs attribute file display_text, exiting...\n");
+    pr_err("Error creating sysfs attribute files, exiting...\n");
 
     /* Dynamically frees oled_kobj allocated by kobject_create_and_add. */
     kobject_put(oled_kobj);
+    oled_kobj = NULL;
+    status_code = -1;
+    goto RETURN;
+  }
+
+  /* The directory /sys/kernel/oled_sysfs/regions holds one directory per
+   * region. */
+  regions_kobj = kobject_create_and_add("regions", oled_kobj);
+  if ((NULL == regions_kobj) ||
+      (sysfs_create_group(regions_kobj, &regions_attr_group) != 0)) {
+    pr_err("Error creating sysfs regions directory, exiting...\n");
+
+    kobject_put(regions_kobj);
+    regions_kobj = NULL;
+    sysfs_remove_group(oled_kobj, &oled_attr_group);
+    kobject_put(oled_kobj);
+    oled_kobj = NULL;
     status_code = -1;
     goto RETURN;
   }
@@ -138,6 +1394,44 @@ RETURN:
   return status_code;
 }
 
+/**
+ * @brief Removes the attribute files created in oled_sysfs_init and returns
+ * the screen to text mode. Once this returns no store callback is running or
+ * can start a display mode or the printk console again.
+ * @param  None.
+ * @return None.
+ * @note oled_kobj itself stays until oled_sysfs_deinit, the frame scheduler
+ * notifies through it.
+ */
+void oled_sysfs_remove(void) {
+  int index;
+
+  if ((NULL == oled_kobj) || (NULL == regions_kobj)) {
+    return;
+  }
+
+  /* Remove the regions before their parent directory. */
+  mutex_lock(&region_kobj_lock);
+  for (index = 0; index < OLED_REGION_MAX; ++index) {
+    if (region_kobjs[index]) {
+      region_kobj_remove(index);
+    }
+  }
+  mutex_unlock(&region_kobj_lock);
+
+  sysfs_remove_group(regions_kobj, &regions_attr_group);
+  kobject_put(regions_kobj);
+  regions_kobj = NULL;
+
+  /* Remove attribute files from sysfs, waiting for running callbacks. */
+  sysfs_remove_group(oled_kobj, &oled_attr_group);
+
+  mutex_lock(&display_mode_lock);
+  oled_display_mode_leave();
+  oled_graphics_params.display_mode = OLED_MODE_TEXT;
+  mutex_unlock(&display_mode_lock);
+}
+
 /**
  * @brief Cleans up the constructs created in oled_sysfs_init.
  *        Deletes the kernel object allocated and the sysfs folder created for
@@ -149,10 +1443,14 @@ void oled_sysfs_deinit(void) {
   /* Print to kernel logs. */
   pr_info("Deleting oled_sysfs kobject. \n");
 
-  /* Remove display_text file from sysfs. */
-  sysfs_remove_file(oled_kobj, &kobj_attr_display_text.attr);
+  if (NULL == oled_kobj) {
+    return;
+  }
+
+  oled_sysfs_remove();
 
   /* Removes kobject from sysfs, which also deletes the oled_sysfs directory in
    * /sys/kernel/. */
   kobject_put(oled_kobj);
+  oled_kobj = NULL;
 }
\ No newline at end of file
@@ -15,6 +15,15 @@
  */
 int oled_sysfs_init(void);
 
+/**
+ * @brief Removes the attribute files created in oled_sysfs_init and returns
+ * the screen to text mode. Once this returns no store callback is running or
+ * can start a display mode or the printk console again.
+ * @param  None.
+ * @return None.
+ */
+void oled_sysfs_remove(void);
+
 /**
  * @brief Cleans up the constructs created in oled_sysfs_init.
  *        Deletes the kernel object allocated and the sysfs folder created for